@@ -0,0 +1,341 @@
+#pragma once
+#include "cache_lru.h"
+#include "pool_trabajo.h"
+#include "traza.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Métricas horizontales de una fuente TrueType leídas del propio archivo (head, hhea, maxp,
+// hmtx, cmap) para medir texto sin el motor de render. En fuentes variables como Inter se aplica
+// el eje de peso con fvar/avar/HVAR, porque el proyector usa font-weight 900 y los glifos
+// negros son bastante más anchos que los del peso por defecto.
+class MetricasFuente {
+private:
+    std::vector<uint8_t> datos;
+    std::vector<float> avance_glifo;  // en em, con la variación aplicada
+    std::vector<uint16_t> glifo_bmp;  // punto de código < 0x10000 -> glifo
+    float alto_linea_em = 1.2f;
+    float avance_promedio_em = 0.55f;
+
+    uint8_t u8(size_t off) const { return off < datos.size() ? datos[off] : 0; }
+    uint16_t u16(size_t off) const { return off + 2 <= datos.size() ? static_cast<uint16_t>(datos[off] << 8 | datos[off + 1]) : 0; }
+    uint32_t u32(size_t off) const { return off + 4 <= datos.size() ? static_cast<uint32_t>(u16(off)) << 16 | u16(off + 2) : 0; }
+    int16_t i16(size_t off) const { return static_cast<int16_t>(u16(off)); }
+    float f2dot14(size_t off) const { return i16(off) / 16384.0f; }
+    float fixed(size_t off) const { return static_cast<int32_t>(u32(off)) / 65536.0f; }
+
+    size_t tabla(const char* etiqueta, size_t* largo = nullptr) const {
+        uint16_t n = u16(4);
+        for (uint16_t i = 0; i < n; ++i) {
+            size_t r = 12 + size_t(i) * 16;
+            if (r + 16 <= datos.size() && std::memcmp(&datos[r], etiqueta, 4) == 0) {
+                size_t off = u32(r + 8), len = u32(r + 12);
+                if (off + len > datos.size()) return 0;
+                if (largo) *largo = len;
+                return off;
+            }
+        } return 0;
+    }
+
+    void leer_cmap() {
+        glifo_bmp.assign(0x10000, 0);
+        size_t cmap = tabla("cmap"); if (!cmap) return;
+        size_t elegido = 0; int prioridad = -1;
+        for (uint16_t i = 0, n = u16(cmap + 2); i < n; ++i) {
+            size_t r = cmap + 4 + size_t(i) * 8;
+            uint16_t plataforma = u16(r), codificacion = u16(r + 2); size_t sub = cmap + u32(r + 4);
+            uint16_t formato = u16(sub);
+            int p = (formato == 12 && (plataforma == 3 || plataforma == 0)) ? 2 : (formato == 4 && (plataforma == 3 || plataforma == 0)) ? 1 : -1;
+            if (plataforma == 3 && codificacion != 1 && codificacion != 10) p = -1;
+            if (p > prioridad) { prioridad = p; elegido = sub; }
+        }
+        if (prioridad == 2) {
+            uint32_t n = std::min<uint32_t>(u32(elegido + 12), static_cast<uint32_t>(datos.size() / 12));
+            for (uint32_t g = 0; g < n; ++g) {
+                size_t r = elegido + 16 + size_t(g) * 12;
+                uint32_t inicio = u32(r), fin = std::min<uint32_t>(u32(r + 4), 0xFFFF), glifo = u32(r + 8);
+                for (uint32_t cp = inicio; cp <= fin && inicio <= 0xFFFF; ++cp) glifo_bmp[cp] = static_cast<uint16_t>(glifo + cp - inicio);
+            }
+        } else if (prioridad == 1) {
+            size_t segs = u16(elegido + 6) / 2;
+            size_t fines = elegido + 14, inicios = fines + segs * 2 + 2, deltas = inicios + segs * 2, rangos = deltas + segs * 2;
+            for (size_t s = 0; s < segs; ++s) {
+                uint16_t fin = u16(fines + s * 2), inicio = u16(inicios + s * 2), delta = u16(deltas + s * 2), rango = u16(rangos + s * 2);
+                for (uint32_t cp = inicio; cp <= fin && cp != 0xFFFF; ++cp) {
+                    uint16_t g = rango == 0 ? static_cast<uint16_t>(cp + delta) : u16(rangos + s * 2 + rango + (cp - inicio) * 2);
+                    if (rango != 0 && g != 0) g = static_cast<uint16_t>(g + delta);
+                    glifo_bmp[cp] = g;
+                }
+            }
+        }
+    }
+
+    // Coordenada normalizada (-1..1) del eje de peso, con el remapeo de avar si existe
+    float coordenada_peso(float peso, size_t& eje, size_t& num_ejes) const {
+        size_t fvar = tabla("fvar"); eje = SIZE_MAX; num_ejes = 0;
+        if (!fvar) return 0;
+        size_t ejes = fvar + u16(fvar + 4); num_ejes = u16(fvar + 8); size_t tam = u16(fvar + 10);
+        float c = 0;
+        for (size_t i = 0; i < num_ejes; ++i) {
+            size_t r = ejes + i * tam;
+            if (r + 16 > datos.size() || std::memcmp(&datos[r], "wght", 4) != 0) continue;
+            float minimo = fixed(r + 4), defecto = fixed(r + 8), maximo = fixed(r + 12);
+            peso = std::clamp(peso, minimo, maximo);
+            c = peso < defecto ? (defecto > minimo ? (peso - defecto) / (defecto - minimo) : 0) : (maximo > defecto ? (peso - defecto) / (maximo - defecto) : 0);
+            eje = i; break;
+        }
+        size_t avar = tabla("avar");
+        if (avar && eje != SIZE_MAX) {
+            size_t r = avar + 8;
+            for (size_t i = 0; i < num_ejes; ++i) {
+                uint16_t pares = u16(r); r += 2;
+                if (i == eje) {
+                    for (uint16_t p = 1; p < pares; ++p) {
+                        float desde0 = f2dot14(r + (p - 1) * 4), hacia0 = f2dot14(r + (p - 1) * 4 + 2), desde1 = f2dot14(r + p * 4), hacia1 = f2dot14(r + p * 4 + 2);
+                        if (c >= desde0 && c <= desde1) { c = desde1 > desde0 ? hacia0 + (c - desde0) * (hacia1 - hacia0) / (desde1 - desde0) : hacia0; break; }
+                    }
+                }
+                r += size_t(pares) * 4;
+            }
+        }
+        return c;
+    }
+
+    // Suma los deltas de HVAR a los avances, para la coordenada dada en el eje `eje`
+    void aplicar_hvar(float coord, size_t eje, size_t num_ejes) {
+        size_t hvar = tabla("HVAR"); if (!hvar || eje == SIZE_MAX || coord == 0) return;
+        size_t almacen = hvar + u32(hvar + 4); uint32_t mapa_off = u32(hvar + 8);
+        size_t regiones = almacen + u32(almacen + 2);
+        uint16_t ejes_region = u16(regiones), num_regiones = u16(regiones + 2);
+        if (ejes_region != num_ejes) return;
+        std::vector<float> escala(num_regiones, 1.0f);
+        for (uint16_t r = 0; r < num_regiones; ++r) {
+            for (size_t a = 0; a < num_ejes; ++a) {
+                size_t off = regiones + 4 + (size_t(r) * num_ejes + a) * 6;
+                float inicio = f2dot14(off), pico = f2dot14(off + 2), fin = f2dot14(off + 4);
+                float c = a == eje ? coord : 0.0f, s = 1.0f;
+                if (pico == 0 || inicio > pico || pico > fin || (inicio < 0 && fin > 0)) s = 1.0f;
+                else if (c == pico) s = 1.0f;
+                else if (c <= inicio || c >= fin) s = 0.0f;
+                else s = c < pico ? (c - inicio) / (pico - inicio) : (fin - c) / (fin - pico);
+                escala[r] *= s;
+            }
+        }
+        uint16_t num_datos = u16(almacen + 6);
+        for (size_t g = 0; g < avance_glifo.size(); ++g) {
+            uint32_t exterior = 0, interior = static_cast<uint32_t>(g);
+            if (mapa_off) {
+                size_t mapa = hvar + mapa_off; uint8_t formato = u8(mapa), entrada = u8(mapa + 1);
+                uint32_t cantidad = formato == 0 ? u16(mapa + 2) : u32(mapa + 2); size_t base = mapa + (formato == 0 ? 4 : 6);
+                if (cantidad == 0) continue;
+                size_t bytes = ((entrada & 0x30) >> 4) + 1, bits_interior = (entrada & 0x0F) + 1;
+                size_t off = base + std::min<size_t>(g, cantidad - 1) * bytes; uint32_t v = 0;
+                for (size_t b = 0; b < bytes; ++b) v = v << 8 | u8(off + b);
+                exterior = v >> bits_interior; interior = v & ((1u << bits_interior) - 1);
+            }
+            if (exterior >= num_datos) continue;
+            size_t item = almacen + u32(almacen + 8 + size_t(exterior) * 4);
+            uint16_t items = u16(item), palabras = u16(item + 2), indices = u16(item + 4);
+            if (interior >= items) continue;
+            bool largas = palabras & 0x8000; size_t cortas = palabras & 0x7FFF;
+            size_t fila = largas ? cortas * 4 + (indices - cortas) * 2 : cortas * 2 + (indices - cortas);
+            size_t off = item + 6 + size_t(indices) * 2 + size_t(interior) * fila;
+            float delta = 0;
+            for (size_t k = 0; k < indices; ++k) {
+                int32_t d;
+                if (k < cortas) { d = largas ? static_cast<int32_t>(u32(off)) : i16(off); off += largas ? 4 : 2; }
+                else { d = largas ? i16(off) : static_cast<int8_t>(u8(off)); off += largas ? 2 : 1; }
+                uint16_t region = u16(item + 6 + k * 2);
+                if (region < num_regiones) delta += escala[region] * d;
+            }
+            avance_glifo[g] += delta;
+        }
+    }
+
+public:
+    bool cargar(const std::filesystem::path& ruta, float peso = 400) {
+        std::ifstream in(ruta, std::ios::binary);
+        if (!in) return false;
+        datos.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        size_t head = tabla("head"), hhea = tabla("hhea"), maxp = tabla("maxp"), hmtx_largo = 0, hmtx = tabla("hmtx", &hmtx_largo);
+        if (!head || !hhea || !maxp || !hmtx) { datos.clear(); return false; }
+        float unidades = u16(head + 18); if (unidades <= 0) { datos.clear(); return false; }
+        alto_linea_em = (i16(hhea + 4) - i16(hhea + 6) + i16(hhea + 8)) / unidades;
+        size_t num_glifos = u16(maxp + 4), num_metricas = std::min<size_t>(u16(hhea + 34), hmtx_largo / 4);
+        if (num_metricas == 0) { datos.clear(); return false; }
+        avance_glifo.assign(num_glifos, 0);
+        for (size_t g = 0; g < num_glifos; ++g) avance_glifo[g] = u16(hmtx + std::min(g, num_metricas - 1) * 4);
+        size_t eje, num_ejes; float coord = coordenada_peso(peso, eje, num_ejes);
+        aplicar_hvar(coord, eje, num_ejes);
+        for (auto& a : avance_glifo) a /= unidades;
+        leer_cmap();
+        // Promedio de las minúsculas, para caracteres que la fuente no tiene
+        float suma = 0; for (char c = 'a'; c <= 'z'; ++c) suma += avance(static_cast<unsigned char>(c));
+        if (suma > 0) avance_promedio_em = suma / 26;
+        datos.clear(); datos.shrink_to_fit();
+        return true;
+    }
+
+    bool cargada() const { return !avance_glifo.empty(); }
+    float alto_linea() const { return alto_linea_em; }
+
+    float avance(char32_t cp) const {
+        uint16_t g = cp < glifo_bmp.size() ? glifo_bmp[cp] : 0;
+        return g != 0 && g < avance_glifo.size() ? avance_glifo[g] : avance_promedio_em;
+    }
+};
+
+// Elige el tamaño de letra más grande con el que el texto, envuelto por palabras como lo hace
+// el Text del proyector, cabe en el área disponible. Los resultados se memorizan por
+// (hash del texto, área) y se pueden precalcular en segundo plano para toda una lista de diapositivas.
+class AjusteTexto {
+public:
+    struct Area { int ancho = 0; int alto = 0; };
+
+private:
+    struct Clave {
+        uint64_t hash_texto; int ancho; int alto;
+        bool operator==(const Clave& o) const { return hash_texto == o.hash_texto && ancho == o.ancho && alto == o.alto; }
+    };
+    struct ClaveHash {
+        std::size_t operator()(const Clave& k) const {
+            uint64_t x = k.hash_texto ^ (static_cast<uint64_t>(static_cast<uint32_t>(k.ancho)) << 32 | static_cast<uint32_t>(k.alto));
+            x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL; x ^= x >> 27; x *= 0x94d049bb133111ebULL; x ^= x >> 31;
+            return static_cast<std::size_t>(x);
+        }
+    };
+
+    MetricasFuente fuente;
+    float tamano_min, tamano_max;
+    CacheLRU<Clave, float, ClaveHash> memo{512 * 1024};
+    PoolTrabajo pool{1};
+
+    // FNV-1a de 64 bits
+    static uint64_t hash_texto(std::string_view s) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : s) { h ^= c; h *= 0x100000001b3ULL; }
+        return h;
+    }
+
+    // Siguiente punto de código UTF-8; los bytes inválidos cuentan como un carácter
+    static char32_t siguiente_cp(std::string_view s, size_t& i) {
+        unsigned char c = static_cast<unsigned char>(s[i++]);
+        if (c < 0x80) return c;
+        int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+        char32_t cp = c & (0x3F >> extra);
+        for (int k = 0; k < extra && i < s.size() && (static_cast<unsigned char>(s[i]) & 0xC0) == 0x80; ++k) cp = cp << 6 | (static_cast<unsigned char>(s[i++]) & 0x3F);
+        return cp;
+    }
+
+    // ¿Cabe el texto con `tamano` px? Envoltura voraz por palabras; una palabra más ancha que la
+    // línea se parte por caracteres. Los saltos de línea del texto se respetan.
+    bool cabe(std::string_view texto, float tamano, const Area& area) const {
+        // 2 % de margen para el redondeo a píxeles del motor de texto
+        float ancho_em = area.ancho * 0.98f / tamano, max_lineas = std::floor(area.alto / (fuente.alto_linea() * tamano) + 1e-4f);
+        if (max_lineas < 1) return false;
+        float espacio = fuente.avance(' ');
+        int lineas = 1; float x = 0; bool inicio_linea = true;
+        size_t i = 0;
+        while (i < texto.size()) {
+            char32_t cp = siguiente_cp(texto, i);
+            if (cp == '\n') { if (++lineas > max_lineas) return false; x = 0; inicio_linea = true; continue; }
+            if (cp == ' ' || cp == '\t' || cp == '\r') continue;
+            // Palabra completa a partir de aquí
+            float ancho_palabra = fuente.avance(cp); size_t j = i;
+            while (j < texto.size()) {
+                size_t k = j; char32_t c = siguiente_cp(texto, k);
+                if (c == ' ' || c == '\t' || c == '\r' || c == '\n') break;
+                ancho_palabra += fuente.avance(c); j = k;
+            }
+            float necesario = inicio_linea ? ancho_palabra : x + espacio + ancho_palabra;
+            if (necesario <= ancho_em) { x = necesario; inicio_linea = false; i = j; continue; }
+            if (!inicio_linea) { if (++lineas > max_lineas) return false; x = 0; inicio_linea = true; }
+            if (ancho_palabra <= ancho_em) { x = ancho_palabra; inicio_linea = false; i = j; continue; }
+            // Palabra más larga que la línea: se corta carácter por carácter
+            x = fuente.avance(cp); inicio_linea = false;
+            while (i < j) {
+                char32_t c = siguiente_cp(texto, i); float a = fuente.avance(c);
+                if (x + a > ancho_em) { if (++lineas > max_lineas) return false; x = 0; }
+                x += a;
+            }
+        }
+        return lineas <= max_lineas;
+    }
+
+    float calcular(std::string_view texto, const Area& area) const {
+        if (!fuente.cargada() || area.ancho <= 0 || area.alto <= 0) return tamano_por_largo(texto);
+        // Búsqueda binaria en pasos de 1 px; cabe() es monótona en el tamaño
+        int bajo = static_cast<int>(tamano_min), alto = static_cast<int>(tamano_max);
+        if (cabe(texto, static_cast<float>(alto), area)) return static_cast<float>(alto);
+        while (alto - bajo > 1) {
+            int medio = (bajo + alto) / 2;
+            if (cabe(texto, static_cast<float>(medio), area)) bajo = medio; else alto = medio;
+        }
+        return static_cast<float>(bajo);
+    }
+
+    // Sin fuente: la escala por cantidad de caracteres de siempre, contando caracteres y no bytes
+    float tamano_por_largo(std::string_view texto) const {
+        size_t len = 0; for (unsigned char c : texto) if ((c & 0xC0) != 0x80) len++;
+        float t = 85.0f;
+        if (len >= 450) t = 32.0f; else if (len >= 320) t = 38.0f; else if (len >= 220) t = 46.0f; else if (len >= 120) t = 56.0f; else if (len >= 60) t = 68.0f;
+        return std::clamp(t, tamano_min, tamano_max);
+    }
+
+public:
+    // `peso` es el font-weight del texto proyectado
+    AjusteTexto(const std::filesystem::path& ruta_fuente, float peso, float minimo = 24.0f, float maximo = 85.0f) : tamano_min(minimo), tamano_max(maximo) {
+        fuente.cargar(ruta_fuente, peso);
+    }
+
+    bool fuente_cargada() const { return fuente.cargada(); }
+
+    // Tamaño para proyectar `texto` en `area` (px lógicos). Si no estaba precalculado se calcula aquí:
+    // son unos microsegundos por diapositiva.
+    float tamano(std::string_view texto, const Area& area) {
+        Clave clave{ hash_texto(texto), area.ancho, area.alto };
+        if (auto t = memo.buscar(clave)) return *t;
+        traza::Medicion m(traza::Etapa::Ajuste, "calcular tamaño");
+        float t = calcular(texto, area);
+        memo.insertar(clave, std::make_shared<const float>(t), sizeof(float) + 64);
+        return t;
+    }
+
+    // Para el hilo de la UI: nunca mide aquí. Si el tamaño está memorizado lo devuelve; si no, devuelve el
+    // de la escala por largo como provisorio y mide en el pool, detrás de la precarga en curso (que suele
+    // incluir este mismo texto), y `medido` recibe ahí el tamaño exacto.
+    float tamano_sin_esperar(std::string texto, const Area& area, std::function<void(float)> medido) {
+        if (auto t = memo.buscar(Clave{ hash_texto(texto), area.ancho, area.alto })) return *t;
+        float provisorio = tamano_por_largo(texto);
+        pool.encolar([this, texto = std::move(texto), area, medido = std::move(medido)]() { medido(tamano(texto, area)); }, PoolTrabajo::Prioridad::SegundoPlano);
+        return provisorio;
+    }
+
+    // Calcula en segundo plano los tamaños de todas las diapositivas que se acaban de cargar. `lista` es
+    // la misma que muestra el panel (un vector de elementos con campo `texto`, compartido e inmutable):
+    // el pool la lee ahí mismo, sin copiar los textos en el hilo de la UI.
+    // Lo que quedaba pendiente de una carga anterior se descarta.
+    template <typename Lista> void precalcular(std::shared_ptr<const Lista> lista, const Area& area) {
+        if (!lista) return;
+        pool.descartar_pendientes(PoolTrabajo::Prioridad::PrimerPlano);
+        pool.encolar([this, lista = std::move(lista), area]() {
+            traza::Medicion m(traza::Etapa::Ajuste, "precalcular tamaños");
+            for (const auto& elemento : *lista) {
+                const std::string& texto = elemento.texto;
+                Clave clave{ hash_texto(texto), area.ancho, area.alto };
+                if (!memo.contiene(clave)) memo.insertar(clave, std::make_shared<const float>(calcular(texto, area)), sizeof(float) + 64, true);
+            }
+        });
+    }
+
+    EstadisticasCache get_estadisticas() const { return memo.get_estadisticas(); }
+};
@@ -0,0 +1,607 @@
+#include "app_state.h"
+#include "directorio_datos.h"
+#include "indice_libros.h"
+#include "referencia_biblica.h"
+#include "traza.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+std::string trim(const std::string& str) {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (std::string::npos == first) return "";
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, (last - first + 1));
+}
+
+std::vector<std::string> dividir_estrofas(const std::string& letra) {
+    std::vector<std::string> estrofas; size_t start = 0, end = 0;
+    while ((end = letra.find("\n\n", start)) != std::string::npos) {
+        std::string estrofa = trim(letra.substr(start, end - start));
+        if (!estrofa.empty()) estrofas.push_back(std::move(estrofa));
+        start = end + 2;
+    }
+    std::string estrofa = trim(letra.substr(start));
+    if (!estrofa.empty()) estrofas.push_back(std::move(estrofa));
+    return estrofas;
+}
+
+std::string consulta_fts_prefijos(const std::string& busqueda, size_t& longitud) {
+    std::string consulta, token; longitud = 0;
+    auto cerrar = [&]() { if (token.empty()) return; if (!consulta.empty()) consulta += ' '; consulta += '"' + token + "\"*"; longitud += token.size(); token.clear(); };
+    for (unsigned char c : busqueda) {
+        if (c >= 0x80 || std::isalnum(c)) token.push_back(static_cast<char>(c)); else cerrar();
+    }
+    cerrar(); return consulta;
+}
+
+std::string buscar_libro_inteligente(std::string_view query, int& out_id) {
+    static const IndiceLibros indice;
+    return std::string(indice.buscar(query, out_id));
+}
+
+sqlite3* AppState::setup_db(const std::string& db_name) {
+    std::string base_path = directorio_datos();
+    if (!fs::exists(base_path)) fs::create_directories(base_path);
+    sqlite3* db;
+    if (sqlite3_open((base_path + db_name).c_str(), &db) != SQLITE_OK) return nullptr;
+    sqlite3_exec(db, "PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;", nullptr, nullptr, nullptr);
+    return db;
+}
+
+void AppState::preparar_indice_fts() {
+    sqlite3_exec(cantos_db, "CREATE INDEX IF NOT EXISTS idx_diapositivas_canto ON diapositivas(canto_id, orden)", nullptr, nullptr, nullptr);
+    bool existe = false;
+    { SentenciaUso stmt(cantos_sql, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'cantos_fts'"); existe = stmt && sqlite3_step(stmt) == SQLITE_ROW; }
+    if (existe) return;
+    Transaccion tx(cantos_db);
+    const char* sql =
+        "CREATE VIRTUAL TABLE cantos_fts USING fts5(titulo, texto, canto_id UNINDEXED, orden UNINDEXED, tokenize = 'unicode61 remove_diacritics 2', prefix = '1 2 3');"
+        "INSERT INTO cantos_fts(cantos_fts, rank) VALUES ('rank', 'bm25(10.0, 1.0)');"
+        "INSERT INTO cantos_fts(rowid, titulo, texto, canto_id, orden) SELECT -id, titulo, '', id, 0 FROM cantos;"
+        "INSERT INTO cantos_fts(rowid, titulo, texto, canto_id, orden) SELECT id, '', texto, canto_id, orden FROM diapositivas;";
+    if (sqlite3_exec(cantos_db, sql, nullptr, nullptr, nullptr) == SQLITE_OK) tx.confirmar();
+    else std::cerr << "[FTS] No se pudo crear el índice de búsqueda: " << sqlite3_errmsg(cantos_db) << std::endl;
+}
+
+void AppState::preparar_listas_servicio() {
+    const char* sql =
+        "CREATE TABLE IF NOT EXISTS listas_servicio (id INTEGER PRIMARY KEY AUTOINCREMENT, nombre TEXT NOT NULL);"
+        "CREATE TABLE IF NOT EXISTS elementos_lista (lista_id INTEGER NOT NULL, orden INTEGER NOT NULL, canto_id INTEGER NOT NULL DEFAULT 0, referencia TEXT NOT NULL DEFAULT '', PRIMARY KEY (lista_id, orden)) WITHOUT ROWID;";
+    if (sqlite3_exec(cantos_db, sql, nullptr, nullptr, nullptr) != SQLITE_OK) std::cerr << "[Servicio] No se pudieron crear las tablas: " << sqlite3_errmsg(cantos_db) << std::endl;
+}
+
+bool AppState::indexar_titulo_fts(int canto_id, const std::string& titulo) {
+    SentenciaUso stmt(cantos_sql, "INSERT INTO cantos_fts (rowid, titulo, texto, canto_id, orden) VALUES (?, ?, '', ?, 0)");
+    if (!stmt) return false;
+    sqlite3_bind_int(stmt, 1, -canto_id); sqlite3_bind_text(stmt, 2, titulo.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 3, canto_id);
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+bool AppState::desindexar_canto_fts(int canto_id) {
+    std::vector<sqlite3_int64> rowids{ -static_cast<sqlite3_int64>(canto_id) };
+    {
+        SentenciaUso stmt(cantos_sql, "SELECT id FROM diapositivas WHERE canto_id = ?");
+        if (!stmt) return false;
+        sqlite3_bind_int(stmt, 1, canto_id);
+        while (sqlite3_step(stmt) == SQLITE_ROW) rowids.push_back(sqlite3_column_int64(stmt, 0));
+    }
+    SentenciaUso stmt(cantos_sql, "DELETE FROM cantos_fts WHERE rowid = ?");
+    if (!stmt) return false;
+    for (auto rowid : rowids) {
+        sqlite3_bind_int64(stmt, 1, rowid);
+        if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+        sqlite3_reset(stmt);
+    } return true;
+}
+
+bool AppState::insert_diapositivas_intern(int canto_id, const std::string& letra, size_t* insertadas) {
+    SentenciaUso stmt(cantos_sql, "INSERT INTO diapositivas (canto_id, orden, texto) VALUES (?, ?, ?)");
+    SentenciaUso fts(cantos_sql, "INSERT INTO cantos_fts (rowid, titulo, texto, canto_id, orden) VALUES (?, '', ?, ?, ?)");
+    if (!stmt || !fts) return false;
+    int orden = 1;
+    for (const auto& estrofa : dividir_estrofas(letra)) {
+        sqlite3_bind_int(stmt, 1, canto_id); sqlite3_bind_int(stmt, 2, orden); sqlite3_bind_text(stmt, 3, estrofa.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+        sqlite3_reset(stmt);
+        sqlite3_bind_int64(fts, 1, sqlite3_last_insert_rowid(cantos_db)); sqlite3_bind_text(fts, 2, estrofa.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(fts, 3, canto_id); sqlite3_bind_int(fts, 4, orden++);
+        if (sqlite3_step(fts) != SQLITE_DONE) return false;
+        sqlite3_reset(fts);
+        if (insertadas) (*insertadas)++;
+    } return true;
+}
+
+bool AppState::insert_canto_intern(const std::string& titulo, const std::string& categoria, int& out_id) {
+    {
+        SentenciaUso stmt(cantos_sql, "INSERT INTO cantos (titulo, tono, categoria) VALUES (?, '', ?)");
+        if (!stmt) return false;
+        sqlite3_bind_text(stmt, 1, titulo.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 2, categoria.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+    }
+    out_id = static_cast<int>(sqlite3_last_insert_rowid(cantos_db));
+    return indexar_titulo_fts(out_id, titulo);
+}
+
+size_t AppState::presupuesto_cache_capitulos() {
+    size_t mb = 64;
+    if (const char* env = std::getenv("EASYPRESENTER_CACHE_MB")) { long v = std::atol(env); if (v > 0) mb = static_cast<size_t>(v); }
+    return mb * 1024 * 1024;
+}
+
+void AppState::procesar_versiones() {
+    auto con = lectores_biblias.prestar(); if (!con) return;
+    SentenciaUso stmt(con->sql, "SELECT id, nombre FROM versiones");
+    if (stmt) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int id = sqlite3_column_int(stmt, 0); 
+            std::string nombre_bd = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            
+            std::string sigla = "OTRA"; 
+            std::string nombre_comp = nombre_bd;
+            int prioridad = 999; 
+
+            // --- BÚSQUEDA EXACTA ---
+            // Comparamos exactamente con los nombres de tu base de datos
+            
+            if (nombre_bd == "ReinaValera1960") { 
+                sigla = "RVR"; nombre_comp = "Reina Valera 1960"; prioridad = 0; 
+            }
+            else if (nombre_bd == "NuevaVersiónInternacional") { 
+                sigla = "NVI"; nombre_comp = "Nueva Versión Internacional"; prioridad = 1; 
+            }
+            else if (nombre_bd == "NuevaTraduccionViviente") { 
+                sigla = "NTV"; nombre_comp = "Nueva Traducción Viviente"; prioridad = 2; 
+            }
+            else if (nombre_bd == "BibliaDeLasAméricas") { 
+                sigla = "LBLA"; nombre_comp = "La Biblia de las Américas"; prioridad = 3; 
+            }
+            else if (nombre_bd == "NuevaBibliadelasAméricas") { 
+                sigla = "NBLA"; nombre_comp = "Nueva Biblia de las Américas"; prioridad = 4; 
+            }
+            else if (nombre_bd == "TraduccionLenguajeActual") { 
+                sigla = "TLA"; nombre_comp = "Traducción en Lenguaje Actual"; prioridad = 5; 
+            }
+            else if (nombre_bd == "DiosHablaHoy") { 
+                sigla = "DHH"; nombre_comp = "Dios Habla Hoy"; prioridad = 6; 
+            }
+            else if (nombre_bd == "LaPalabra") { 
+                sigla = "BLP"; nombre_comp = "La Palabra"; prioridad = 7; 
+            }
+            else if (nombre_bd == "TraduccionInterconfesionalVersionHispanoamericana") { 
+                sigla = "TIVH"; nombre_comp = "Trad. Interconfesional Hispanoamericana"; prioridad = 8; 
+            }
+            else if (nombre_bd == "BibliaTextual") { 
+                sigla = "BTX"; nombre_comp = "Biblia Textual"; prioridad = 9; 
+            }
+            else if (nombre_bd == "BibliaJubileo") { 
+                sigla = "JUB"; nombre_comp = "Biblia del Jubileo"; prioridad = 10; 
+            }
+            else if (nombre_bd == "BibliadelOso1573") { 
+                sigla = "OSO"; nombre_comp = "Biblia del Oso 1573"; prioridad = 11; 
+            }
+            else {
+                // Por si en el futuro agregas una biblia que no está en esta lista
+                sigla = nombre_bd.length() >= 4 ? nombre_bd.substr(0, 4) : nombre_bd;
+                std::transform(sigla.begin(), sigla.end(), sigla.begin(), ::toupper);
+            }
+
+            versiones_cargadas.push_back({id, sigla, nombre_comp, prioridad});
+        }
+    }
+    
+    // Ordenamos por la prioridad que asignaste arriba (0, 1, 2, 3...)
+    std::sort(versiones_cargadas.begin(), versiones_cargadas.end(), [](const VersionInfo& a, const VersionInfo& b) { 
+        return a.prioridad < b.prioridad; 
+    });
+
+    if (!versiones_cargadas.empty()) current_version_id = versiones_cargadas[0].id;
+}
+
+std::string AppState::cargar_metadatos_biblias() {
+    if (paquete_biblias.abierto()) {
+        paquete_biblias.recorrer_libros([this](int version_id, int numero, std::string_view nombre, const std::vector<int>& versos) {
+            metadatos_biblias[version_id].push_back({ numero, std::string(nombre), static_cast<int>(versos.size()), versos });
+        });
+        return "biblias.pack";
+    }
+    std::string origen = "capitulos_meta";
+    bool existe = false;
+    {
+        auto con = lectores_biblias.prestar(); if (!con) return "ninguno";
+        SentenciaUso stmt(con->sql, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'capitulos_meta'"); existe = stmt && sqlite3_step(stmt) == SQLITE_ROW;
+    }
+    if (!existe) {
+        // Única escritura en biblias.db: una conexión temporal solo para crear la tabla
+        sqlite3* biblias_db = setup_db("biblias.db"); if (!biblias_db) return "ninguno";
+        std::unique_ptr<sqlite3, int (*)(sqlite3*)> cierre(biblias_db, sqlite3_close);
+        Transaccion tx(biblias_db);
+        const char* sql =
+            "CREATE TABLE capitulos_meta (version_id INTEGER, libro_numero INTEGER, libro_nombre TEXT, capitulo INTEGER, versos INTEGER, PRIMARY KEY (version_id, libro_numero, capitulo)) WITHOUT ROWID;"
+            "INSERT INTO capitulos_meta SELECT version_id, libro_numero, MAX(libro_nombre), capitulo, COUNT(*) FROM versiculos WHERE capitulo >= 1 GROUP BY version_id, libro_numero, capitulo;";
+        if (sqlite3_exec(biblias_db, sql, nullptr, nullptr, nullptr) != SQLITE_OK || !tx.confirmar()) {
+            std::cerr << "[Biblia] No se pudo crear capitulos_meta: " << sqlite3_errmsg(biblias_db) << std::endl; return "ninguno";
+        }
+        origen += " (creada)";
+    }
+    auto con = lectores_biblias.prestar(); if (!con) return "ninguno";
+    SentenciaUso stmt(con->sql, "SELECT version_id, libro_numero, libro_nombre, capitulo, versos FROM capitulos_meta ORDER BY version_id, libro_numero, capitulo");
+    if (stmt) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int libro = sqlite3_column_int(stmt, 1), cap = sqlite3_column_int(stmt, 3);
+            auto& libros = metadatos_biblias[sqlite3_column_int(stmt, 0)];
+            if (libros.empty() || libros.back().id != libro) {
+                const char* nombre = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+                libros.push_back({ libro, nombre ? nombre : "", 0, {} });
+            }
+            auto& l = libros.back();
+            // Capítulos faltantes quedan con 0 versículos, igual que en el paquete
+            if (static_cast<size_t>(cap) > l.versos.size()) l.versos.resize(cap, 0);
+            l.versos[cap - 1] = sqlite3_column_int(stmt, 4); l.capitulos = static_cast<int>(l.versos.size());
+        }
+    } return origen;
+}
+
+bool AppState::existe_capitulo(const CacheKey& key) const {
+    if (!metadatos_listos || metadatos_biblias.empty()) return true;
+    auto it = metadatos_biblias.find(key.version_id); if (it == metadatos_biblias.end()) return false;
+    auto l = std::lower_bound(it->second.begin(), it->second.end(), key.libro_numero, [](const LibroBiblia& a, int n) { return a.id < n; });
+    return l != it->second.end() && l->id == key.libro_numero && key.capitulo >= 1 && key.capitulo <= l->capitulos && l->versos[key.capitulo - 1] > 0;
+}
+
+std::string AppState::directorio_por_defecto() {
+#ifdef EASYPRESENTER_DATOS_DESARROLLO
+    auto datos = ::directorio_datos::resolver(EASYPRESENTER_DATOS_DESARROLLO);
+#else
+    auto datos = ::directorio_datos::resolver();
+#endif
+    std::cout << "[Datos] " << datos.carpeta.string() << " (" << datos.origen << ")" << std::endl;
+    return datos.carpeta.string();
+}
+
+AppState::AppState(DespachadorUI despachar, std::string datos) : directorio(std::move(datos)), despachar_ui(std::move(despachar)) {
+    if (!directorio.empty() && directorio.back() != '/') directorio += '/';
+    std::error_code ec; fs::create_directories(directorio, ec);
+}
+
+void AppState::abrir_cantos() {
+    traza::Medicion m(traza::Etapa::Consulta, "abrir cantos.db");
+    {
+        std::lock_guard<std::mutex> lock(escritura_mutex);
+        cantos_db = setup_db("cantos.db"); cantos_sql.set_conexion(cantos_db);
+        if(cantos_db) { preparar_indice_fts(); preparar_listas_servicio(); lectores_cantos.abrir(directorio_datos() + "cantos.db", LECTORES_CANTOS); }
+        // Aunque no se haya podido abrir: las escrituras que esperaban fallan en vez de esperar para siempre
+        abriendo_cantos = false;
+    }
+    cantos_abierto.notify_all();
+}
+
+std::unique_lock<std::mutex> AppState::bloquear_escritura() {
+    std::unique_lock<std::mutex> lock(escritura_mutex);
+    cantos_abierto.wait(lock, [this]() { return !abriendo_cantos; });
+    return lock;
+}
+
+void AppState::abrir_biblias(const std::function<void(Apertura)>& avisar) {
+    {
+        traza::Medicion m(traza::Etapa::Consulta, "abrir biblias.db");
+        // La conexión de lectura/escritura solo deja la base en modo WAL; después se lee con el pool
+        if (sqlite3* biblias_db = setup_db("biblias.db")) { sqlite3_close(biblias_db); lectores_biblias.abrir(directorio_datos() + "biblias.db", LECTORES_BIBLIAS); }
+        if(lectores_biblias.abierto()) {
+            procesar_versiones();
+            if (paquete_biblias.abrir(directorio_datos() + "biblias.pack", directorio_datos() + "biblias.db")) std::cout << "[Biblia] Usando biblias.pack (mmap)" << std::endl;
+            else std::cout << "[Biblia] biblias.pack no existe, está desactualizado o dañado; se lee de SQLite" << std::endl;
+        }
+    }
+    // Cada etapa se avisa aunque la base no se haya podido abrir, para que la interfaz no espere de más
+    biblias_listas = true; if (avisar) avisar(Apertura::Versiones);
+    if(lectores_biblias.abierto()) {
+        traza::Medicion m(traza::Etapa::Consulta, "metadatos de biblias");
+        auto inicio = std::chrono::steady_clock::now();
+        std::string origen = cargar_metadatos_biblias();
+        std::cout << "[Arranque] Metadatos de biblias desde " << origen << ": " << metadatos_biblias.size() << " versiones en "
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count() << " ms" << std::endl;
+    }
+    metadatos_listos = true; if (avisar) avisar(Apertura::Libros);
+}
+
+void AppState::abrir() { abrir_cantos(); abrir_biblias({}); }
+
+void AppState::abrir_en_segundo_plano(std::function<void(Apertura)> al_avanzar) {
+    auto avisar = [this, al_avanzar = std::move(al_avanzar)](Apertura etapa) { despachar_ui([al_avanzar, etapa]() { al_avanzar(etapa); }); };
+    // Antes de lanzar el hilo: una escritura que llegue mientras tanto espera en bloquear_escritura()
+    { std::lock_guard<std::mutex> lock(escritura_mutex); abriendo_cantos = true; }
+    hilos_apertura.emplace_back([this, avisar]() { traza::Registro::global().nombrar_hilo("abrir cantos"); abrir_cantos(); avisar(Apertura::Cantos); });
+    hilos_apertura.emplace_back([this, avisar]() { traza::Registro::global().nombrar_hilo("abrir biblias"); abrir_biblias(avisar); });
+}
+
+AppState::~AppState() {
+    // Primero se detienen los hilos que usan las conexiones, luego se finalizan las sentencias
+    for (auto& hilo : hilos_apertura) if (hilo.joinable()) hilo.join();
+    pool_capitulos.detener();
+    lectores_cantos.cerrar(); lectores_biblias.cerrar();
+    cantos_sql.finalizar();
+    if (cantos_db) sqlite3_close(cantos_db);
+}
+
+std::vector<CantoDB> AppState::get_all_cantos() {
+    traza::Medicion m(traza::Etapa::Consulta, "get_all_cantos");
+    std::vector<CantoDB> lista; auto con = lectores_cantos.prestar(); if (!con) return lista;
+    SentenciaUso stmt(con->sql, "SELECT id, titulo FROM cantos ORDER BY titulo");
+    if (stmt) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ sqlite3_column_int(stmt, 0), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), "", "" });
+    } return lista;
+}
+
+std::vector<CoincidenciaCanto> AppState::get_cantos_filtrados(const std::string& busqueda, size_t limite) {
+    static constexpr int MAX_RANKEADAS = 3000;
+    traza::Medicion m(traza::Etapa::Consulta, "get_cantos_filtrados");
+    std::vector<CoincidenciaCanto> lista; auto con = lectores_cantos.prestar(); if (!con) return lista;
+    size_t longitud; std::string consulta = consulta_fts_prefijos(busqueda, longitud);
+    if (consulta.empty()) return lista;
+    std::unordered_set<int> vistos;
+    auto recolectar = [&](const char* sql, const std::string& match, size_t filas) {
+        SentenciaUso stmt(con->sql, sql);
+        if (!stmt) return;
+        sqlite3_bind_text(stmt, 1, match.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(filas));
+        while (sqlite3_step(stmt) == SQLITE_ROW && lista.size() < limite) {
+            int id = sqlite3_column_int(stmt, 0);
+            if (!vistos.insert(id).second) continue;
+            const char* frag = sqlite3_column_count(stmt) > 2 ? reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)) : nullptr;
+            lista.push_back({ id, "", sqlite3_column_int(stmt, 1), frag ? frag : "" });
+        }
+    };
+    const char* sql_rankeado = "SELECT canto_id, orden, snippet(cantos_fts, 1, '', '', '…', 10) FROM cantos_fts WHERE cantos_fts MATCH ? ORDER BY rank LIMIT ?";
+    const char* sql_directo = "SELECT canto_id, orden, snippet(cantos_fts, 1, '', '', '…', 10) FROM cantos_fts WHERE cantos_fts MATCH ? LIMIT ?";
+    // Títulos en orden alfabético antes del LIMIT: el orden del índice (rowid = -id) deja primero los más nuevos
+    if (longitud < 3) recolectar("SELECT cantos_fts.canto_id, cantos_fts.orden FROM cantos_fts JOIN cantos ON cantos.id = cantos_fts.canto_id WHERE cantos_fts MATCH ? ORDER BY cantos.titulo LIMIT ?", "{titulo} : " + consulta, limite);
+    else {
+        int coincidencias = 0;
+        {
+            SentenciaUso stmt(con->sql, "SELECT count(*) FROM (SELECT 1 FROM cantos_fts WHERE cantos_fts MATCH ? LIMIT ?)");
+            if (stmt) { sqlite3_bind_text(stmt, 1, consulta.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, MAX_RANKEADAS); if (sqlite3_step(stmt) == SQLITE_ROW) coincidencias = sqlite3_column_int(stmt, 0); }
+        }
+        if (coincidencias < MAX_RANKEADAS) recolectar(sql_rankeado, consulta, limite * 2);
+        else { recolectar(sql_rankeado, "{titulo} : " + consulta, limite); recolectar(sql_directo, "{texto} : " + consulta, limite * 4); }
+    }
+    {
+        SentenciaUso stmt(con->sql, "SELECT titulo FROM cantos WHERE id = ?");
+        if (!stmt) return {};
+        for (auto& c : lista) {
+            sqlite3_bind_int(stmt, 1, c.id);
+            if (sqlite3_step(stmt) == SQLITE_ROW) c.titulo = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            sqlite3_reset(stmt);
+        }
+    }
+    return lista;
+}
+
+std::string AppState::get_canto_titulo(int id) {
+    traza::Medicion m(traza::Etapa::Consulta, "get_canto_titulo");
+    std::string titulo = ""; auto con = lectores_cantos.prestar(); if (!con) return titulo;
+    SentenciaUso stmt(con->sql, "SELECT titulo FROM cantos WHERE id = ?");
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, id); if (sqlite3_step(stmt) == SQLITE_ROW) titulo = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    } return titulo;
+}
+
+std::vector<Diapositiva> AppState::get_canto_diapositivas(int canto_id) {
+    traza::Medicion m(traza::Etapa::Consulta, "get_canto_diapositivas");
+    std::vector<Diapositiva> lista; auto con = lectores_cantos.prestar(); if (!con) return lista;
+    SentenciaUso stmt(con->sql, "SELECT id, orden, texto FROM diapositivas WHERE canto_id = ? ORDER BY orden");
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, canto_id);
+        while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)) });
+    } return lista;
+}
+
+void AppState::add_canto(const std::string& titulo, const std::string& letra) {
+    traza::Medicion m(traza::Etapa::Consulta, "add_canto");
+    auto lock = bloquear_escritura(); Transaccion tx(cantos_db); int id;
+    if (insert_canto_intern(titulo, "Personalizado", id) && insert_diapositivas_intern(id, letra)) tx.confirmar();
+}
+
+void AppState::update_canto(int id, const std::string& titulo, const std::string& letra) {
+    traza::Medicion m(traza::Etapa::Consulta, "update_canto");
+    auto lock = bloquear_escritura(); Transaccion tx(cantos_db);
+    bool ok = desindexar_canto_fts(id);
+    {
+        SentenciaUso stmt(cantos_sql, "UPDATE cantos SET titulo = ? WHERE id = ?");
+        if (stmt && ok) { sqlite3_bind_text(stmt, 1, titulo.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, id); ok = sqlite3_step(stmt) == SQLITE_DONE; }
+    }
+    {
+        SentenciaUso stmt(cantos_sql, "DELETE FROM diapositivas WHERE canto_id = ?");
+        if (stmt && ok) { sqlite3_bind_int(stmt, 1, id); ok = sqlite3_step(stmt) == SQLITE_DONE; }
+    }
+    if (ok && indexar_titulo_fts(id, titulo) && insert_diapositivas_intern(id, letra)) tx.confirmar();
+}
+
+void AppState::delete_canto(int id) {
+    traza::Medicion m(traza::Etapa::Consulta, "delete_canto");
+    auto lock = bloquear_escritura(); Transaccion tx(cantos_db);
+    bool ok = desindexar_canto_fts(id);
+    { SentenciaUso stmt(cantos_sql, "DELETE FROM diapositivas WHERE canto_id = ?"); if (stmt && ok) { sqlite3_bind_int(stmt, 1, id); ok = sqlite3_step(stmt) == SQLITE_DONE; } }
+    { SentenciaUso stmt(cantos_sql, "DELETE FROM cantos WHERE id = ?"); if (stmt && ok) { sqlite3_bind_int(stmt, 1, id); ok = sqlite3_step(stmt) == SQLITE_DONE; } }
+    { SentenciaUso stmt(cantos_sql, "DELETE FROM elementos_lista WHERE canto_id = ?"); if (stmt && ok) { sqlite3_bind_int(stmt, 1, id); ok = sqlite3_step(stmt) == SQLITE_DONE; } }
+    if (ok) tx.confirmar();
+}
+
+ResultadoImportacion AppState::importar_cantos(const std::vector<CantoImportado>& cantos, size_t tamano_lote) {
+    auto lock = bloquear_escritura(); ResultadoImportacion res;
+    auto inicio = std::chrono::steady_clock::now();
+    for (size_t base = 0; base < cantos.size(); base += tamano_lote) {
+        size_t fin = std::min(cantos.size(), base + tamano_lote), cantos_lote = 0, diapos_lote = 0, fallidos_lote = 0;
+        Transaccion tx(cantos_db);
+        if (!tx) { res.fallidos += fin - base; continue; }
+        // Cada canto en su punto de guardado: uno que falla se deshace solo y el resto del lote sigue
+        for (size_t i = base; i < fin; ++i) {
+            PuntoGuardado punto(cantos_db); int id; size_t diapos = 0;
+            if (punto && insert_canto_intern(cantos[i].titulo, "Importado", id) && insert_diapositivas_intern(id, cantos[i].letra, &diapos) && punto.confirmar()) { cantos_lote++; diapos_lote += diapos; }
+            else fallidos_lote++;
+        }
+        if (tx.confirmar()) { res.cantos += cantos_lote; res.diapositivas += diapos_lote; res.fallidos += fallidos_lote; }
+        else res.fallidos += fin - base;
+    }
+    res.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    return res;
+}
+
+int AppState::get_lista_servicio() {
+    {
+        auto con = lectores_cantos.prestar(); if (!con) return 0;
+        SentenciaUso stmt(con->sql, "SELECT MAX(id) FROM listas_servicio");
+        if (stmt && sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) return sqlite3_column_int(stmt, 0);
+    }
+    auto lock = bloquear_escritura();
+    SentenciaUso stmt(cantos_sql, "INSERT INTO listas_servicio (nombre) VALUES ('Servicio')");
+    if (!stmt || sqlite3_step(stmt) != SQLITE_DONE) return 0;
+    return static_cast<int>(sqlite3_last_insert_rowid(cantos_db));
+}
+
+std::vector<ElementoLista> AppState::get_elementos_lista(int lista_id) {
+    std::vector<ElementoLista> lista; auto con = lectores_cantos.prestar(); if (!con) return lista;
+    SentenciaUso stmt(con->sql, "SELECT canto_id, referencia FROM elementos_lista WHERE lista_id = ? ORDER BY orden");
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, lista_id);
+        while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ sqlite3_column_int(stmt, 0), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)) });
+    } return lista;
+}
+
+bool AppState::guardar_elementos_lista(int lista_id, const std::vector<ElementoLista>& elementos) {
+    auto lock = bloquear_escritura(); Transaccion tx(cantos_db);
+    {
+        SentenciaUso stmt(cantos_sql, "DELETE FROM elementos_lista WHERE lista_id = ?");
+        if (!stmt) return false;
+        sqlite3_bind_int(stmt, 1, lista_id); if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+    }
+    SentenciaUso stmt(cantos_sql, "INSERT INTO elementos_lista (lista_id, orden, canto_id, referencia) VALUES (?, ?, ?, ?)");
+    if (!stmt) return false;
+    for (size_t i = 0; i < elementos.size(); ++i) {
+        sqlite3_bind_int(stmt, 1, lista_id); sqlite3_bind_int(stmt, 2, static_cast<int>(i + 1)); sqlite3_bind_int(stmt, 3, elementos[i].canto_id);
+        sqlite3_bind_text(stmt, 4, elementos[i].referencia.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+        sqlite3_reset(stmt);
+    } return tx.confirmar();
+}
+
+std::vector<ContenidoElemento> AppState::materializar_lista(const std::vector<ElementoLista>& elementos, int version_id) {
+    traza::Medicion m(traza::Etapa::Consulta, "materializar_lista");
+    std::vector<ContenidoElemento> contenidos; contenidos.reserve(elementos.size());
+    for (const auto& e : elementos) {
+        ContenidoElemento& c = contenidos.emplace_back();
+        if (e.canto_id != 0) {
+            c.titulo = get_canto_titulo(e.canto_id);
+            c.etiqueta = c.titulo.empty() ? "(canto eliminado)" : c.titulo;
+            if (!c.titulo.empty()) c.diapositivas = get_canto_diapositivas(e.canto_id);
+            continue;
+        }
+        c.biblico = true; c.etiqueta = e.referencia + " (no encontrada)";
+        std::string_view texto = e.referencia; ReferenciaBiblica ref; int libro = -1;
+        if (!leer_referencia(texto, ref) || ref.libro.empty()) continue;
+        std::string nombre = buscar_libro_inteligente(ref.libro, libro);
+        if (libro == -1) continue;
+        c.titulo = nombre + " " + std::to_string(ref.capitulo);
+        c.etiqueta = c.titulo;
+        if (ref.verso_inicio > 0) c.etiqueta += ":" + std::to_string(ref.verso_inicio) + (ref.verso_fin > ref.verso_inicio ? "-" + std::to_string(ref.verso_fin) : "");
+        for (const auto& v : *get_capitulo({ version_id, libro, ref.capitulo }))
+            if (ref.verso_inicio == 0 || (v.versiculo >= ref.verso_inicio && v.versiculo <= ref.verso_fin)) c.diapositivas.push_back({ 0, v.versiculo, v.texto });
+    }
+    return contenidos;
+}
+
+std::string AppState::set_version_by_name(const std::string& name) {
+    if (!biblias_listas) return "";
+    for(const auto& v : versiones_cargadas) {
+        if(v.nombre_completo == name) { current_version_id = v.id; return v.nombre_completo; }
+    } return "";
+}
+
+const std::vector<LibroBiblia>& AppState::get_libros_biblia() const {
+    static const std::vector<LibroBiblia> vacia;
+    if (!metadatos_listos) return vacia;
+    auto it = metadatos_biblias.find(current_version_id);
+    return it != metadatos_biblias.end() ? it->second : vacia;
+}
+
+EstadisticasSentencias AppState::get_estadisticas_sentencias() {
+    EstadisticasSentencias total = cantos_sql.get_estadisticas();
+    for (auto* pool : { &lectores_cantos, &lectores_biblias }) { auto s = pool->get_estadisticas_sentencias(); total.preparadas += s.preparadas; total.reutilizadas += s.reutilizadas; }
+    return total;
+}
+
+EstadisticasPool AppState::get_estadisticas_lectores() {
+    EstadisticasPool total = lectores_cantos.get_estadisticas(), b = lectores_biblias.get_estadisticas();
+    total.prestamos += b.prestamos; total.esperas += b.esperas; total.conexiones += b.conexiones; return total;
+}
+
+Capitulo AppState::leer_capitulo(const CacheKey& key) {
+    bool paquete = biblias_listas && paquete_biblias.abierto();
+    traza::Medicion m(traza::Etapa::Consulta, paquete ? "leer_capitulo (paquete)" : "leer_capitulo (sqlite)");
+    Capitulo lista;
+    if (paquete) {
+        // El paquete es de solo lectura: no necesita conexión
+        auto vista = paquete_biblias.capitulo(key.version_id, key.libro_numero, key.capitulo);
+        lista.reserve(vista.size());
+        for (size_t i = 0; i < vista.size(); ++i) { auto v = vista[i]; lista.push_back({ key.capitulo, v.numero, std::string(v.texto) }); }
+        return lista;
+    }
+    auto con = lectores_biblias.prestar(); if (!con) return lista;
+    SentenciaUso stmt(con->sql, "SELECT versiculo, texto FROM versiculos WHERE version_id = ? AND libro_numero = ? AND capitulo = ? ORDER BY versiculo");
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, key.version_id); sqlite3_bind_int(stmt, 2, key.libro_numero); sqlite3_bind_int(stmt, 3, key.capitulo);
+        while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ key.capitulo, sqlite3_column_int(stmt, 0), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)) });
+    } return lista;
+}
+
+CapituloPtr AppState::get_capitulo(const CacheKey& key) {
+    CapituloPtr cacheado;
+    { traza::Medicion m(traza::Etapa::Cache, "chapter_cache.buscar"); cacheado = chapter_cache.buscar(key); }
+    if (cacheado) return cacheado;
+    auto lista = std::make_shared<const Capitulo>(leer_capitulo(key));
+    if (!lista->empty()) chapter_cache.insertar(key, lista, bytes_capitulo(*lista));
+    return lista;
+}
+
+void AppState::precargar_vecinos(const CacheKey& key) {
+    static constexpr size_t VERSIONES_PRECARGA = 2;
+    pool_capitulos.descartar_pendientes(PoolTrabajo::Prioridad::SegundoPlano);
+    std::vector<CacheKey> claves{ {key.version_id, key.libro_numero, key.capitulo + 1}, {key.version_id, key.libro_numero, key.capitulo - 1} };
+    size_t versiones = biblias_listas ? versiones_cargadas.size() : 0;
+    for (size_t i = 0, n = 0; i < versiones && n < VERSIONES_PRECARGA; ++i) {
+        if (versiones_cargadas[i].id == key.version_id) continue;
+        claves.push_back({versiones_cargadas[i].id, key.libro_numero, key.capitulo}); n++;
+    }
+    for (const auto& clave : claves) {
+        if (!existe_capitulo(clave) || chapter_cache.contiene(clave)) continue;
+        pool_capitulos.encolar([this, clave]() {
+            if (pool_capitulos.pendientes(PoolTrabajo::Prioridad::PrimerPlano) > 0 || chapter_cache.contiene(clave)) return;
+            auto lista = std::make_shared<const Capitulo>(leer_capitulo(clave));
+            if (!lista->empty()) chapter_cache.insertar(clave, lista, bytes_capitulo(*lista), true);
+        }, PoolTrabajo::Prioridad::SegundoPlano);
+    }
+}
+
+void AppState::get_capitulo_async(int libro_numero, int capitulo, std::function<void(CapituloPtr)> callback) {
+    CacheKey key{current_version_id, libro_numero, capitulo};
+    uint64_t gen = ++*generacion_capitulo;
+    CapituloPtr cacheado;
+    { traza::Medicion m(traza::Etapa::Cache, "chapter_cache.buscar"); cacheado = chapter_cache.buscar(key); }
+    if (cacheado) { callback(std::move(cacheado)); precargar_vecinos(key); return; }
+    pool_capitulos.encolar([this, key, gen, callback, generacion = generacion_capitulo, encolado = traza::marca()]() {
+        traza::registrar_desde(traza::Etapa::Salto, "cola de capítulos", encolado);
+        if (gen != *generacion) return;
+        auto lista = std::make_shared<const Capitulo>(leer_capitulo(key));
+        if (!lista->empty()) chapter_cache.insertar(key, lista, bytes_capitulo(*lista));
+        if (gen != *generacion) return;
+        precargar_vecinos(key);
+        despachar_ui([callback, lista = std::move(lista), gen, generacion, enviado = traza::marca()]() {
+            traza::registrar_desde(traza::Etapa::Salto, "capítulo -> UI", enviado);
+            if (gen == *generacion) callback(lista);
+        });
+    });
+}
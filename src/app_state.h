@@ -0,0 +1,227 @@
+#pragma once
+#include "despachador_ui.h"
+#include "importador_cantos.h"
+#include "pool_trabajo.h"
+#include "cache_lru.h"
+#include "paquete_biblia.h"
+#include "conexiones_sqlite.h"
+#include <sqlite3.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct CantoDB { int id; std::string titulo; std::string tono; std::string categoria; };
+struct CoincidenciaCanto { int id; std::string titulo; int orden; std::string fragmento; }; // orden 0: coincidió el título
+struct Diapositiva { int id; int orden; std::string texto; };
+struct LibroBiblia { int id; std::string nombre; int capitulos; std::vector<int> versos; }; // versos[c - 1]: versículos del capítulo c
+struct Versiculo { int capitulo; int versiculo; std::string texto; };
+// Elemento de una lista de servicio tal como se guarda: un canto o una lectura ("Jn 3:16-18") si canto_id es 0
+struct ElementoLista { int canto_id; std::string referencia; };
+// Elemento ya resuelto contra las bases. `titulo` es lo que muestra el panel ("Juan 3") y `etiqueta`
+// lo que muestra la lista ("Juan 3:16-18"). En las lecturas, el orden de cada diapositiva es el versículo.
+struct ContenidoElemento { std::string etiqueta; std::string titulo; bool biblico = false; std::vector<Diapositiva> diapositivas; };
+
+struct CacheKey {
+    int version_id; int libro_numero; int capitulo;
+    bool operator==(const CacheKey& other) const { return version_id == other.version_id && libro_numero == other.libro_numero && capitulo == other.capitulo; }
+};
+// Empaqueta la clave en 64 bits y la mezcla con el finalizador de splitmix64
+struct CacheKeyHash {
+    std::size_t operator()(const CacheKey& k) const {
+        uint64_t x = (static_cast<uint64_t>(static_cast<uint32_t>(k.version_id)) << 32) ^ (static_cast<uint64_t>(static_cast<uint32_t>(k.libro_numero)) << 16) ^ static_cast<uint32_t>(k.capitulo);
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL; x ^= x >> 27; x *= 0x94d049bb133111ebULL; x ^= x >> 31;
+        return static_cast<std::size_t>(x);
+    }
+};
+
+using Capitulo = std::vector<Versiculo>;
+using CapituloPtr = std::shared_ptr<const Capitulo>;
+
+// Tamaño aproximado en memoria de un capítulo, para el presupuesto del cache
+inline size_t bytes_capitulo(const Capitulo& c) {
+    size_t total = sizeof(Capitulo) + c.capacity() * sizeof(Versiculo) + 64;
+    for (const auto& v : c) if (v.texto.capacity() > 15) total += v.texto.capacity() + 1;
+    return total;
+}
+
+struct VersionInfo { int id; std::string sigla; std::string nombre_completo; int prioridad; };
+
+// Recorta espacios y saltos de línea de los extremos
+std::string trim(const std::string& str);
+// Regla de diapositivas: cada bloque separado por una línea en blanco ("\n\n") es una estrofa
+std::vector<std::string> dividir_estrofas(const std::string& letra);
+// Convierte lo que escribe el operador en una consulta FTS5 de prefijos: "gracia, Dios" -> "gracia"* "Dios"*
+// Los separadores ASCII se descartan (así no se cuelan operadores FTS5); los bytes UTF-8 se conservan
+// y el tokenizador se encarga de acentos y mayúsculas. `longitud` recibe los bytes útiles de la consulta.
+std::string consulta_fts_prefijos(const std::string& busqueda, size_t& longitud);
+// Nombre canónico del libro que coincide con `query` (prefijo, sin importar acentos ni mayúsculas, o abreviatura)
+std::string buscar_libro_inteligente(std::string_view query, int& out_id);
+
+struct ResultadoImportacion { size_t cantos = 0; size_t diapositivas = 0; size_t fallidos = 0; double segundos = 0; };
+
+// Etapas de abrir_en_segundo_plano, en el orden en que puede usarlas la interfaz
+enum class Apertura {
+    Cantos,    // cantos.db abierta: búsqueda, edición y listas de servicio
+    Versiones, // versiones conocidas: ya se pueden leer capítulos
+    Libros     // libros y capítulos de cada versión (metadatos)
+};
+
+// Capa de datos: cantos, listas de servicio y biblias. No depende de Slint; lo único que vuelve
+// al hilo de la interfaz pasa por el DespachadorUI que se le da al construirla.
+class AppState {
+private:
+    // cantos.db: una sola conexión de escritura (escritura_mutex) y un pool de lectores.
+    // biblias.db: solo lectores. En WAL las lecturas no esperan a la escritura ni entre sí.
+    std::string directorio;
+    DespachadorUI despachar_ui;
+    sqlite3* cantos_db = nullptr;
+    std::mutex escritura_mutex;
+    // Mientras abrir_en_segundo_plano abre cantos.db (protegido por escritura_mutex). Las escrituras
+    // esperan a que baje; sin esto, una que llegara antes que el hilo de apertura vería cantos_db nulo.
+    bool abriendo_cantos = false;
+    std::condition_variable cantos_abierto;
+    CacheSentencias cantos_sql;
+    PoolLectura lectores_cantos;
+    PoolLectura lectores_biblias;
+    std::vector<VersionInfo> versiones_cargadas;
+    std::atomic<int> current_version_id{1};
+    CacheLRU<CacheKey, Capitulo, CacheKeyHash> chapter_cache{presupuesto_cache_capitulos()};
+    // Solo se entrega el capítulo de la petición más reciente; las anteriores quedan superadas
+    std::shared_ptr<std::atomic<uint64_t>> generacion_capitulo = std::make_shared<std::atomic<uint64_t>>(0);
+    PoolTrabajo pool_capitulos{2};
+
+    paquete_biblia::PaqueteBiblia paquete_biblias; // si está abierto, los versículos se leen de aquí y no de SQLite
+    // Libros de cada versión (por id), ordenados por número. Se arma una sola vez al abrir
+    // y después no cambia, así que se lee sin bloqueos.
+    std::unordered_map<int, std::vector<LibroBiblia>> metadatos_biblias;
+
+    // La apertura en segundo plano llena lo anterior en otro hilo y lo publica con estas banderas.
+    // Antes de biblias_listas los capítulos se leen de SQLite (el pool devuelve vacío si no está abierto)
+    // y no hay versiones; antes de metadatos_listos no hay libros y se asume que todo capítulo existe.
+    std::atomic<bool> biblias_listas{false};
+    std::atomic<bool> metadatos_listos{false};
+    std::vector<std::thread> hilos_apertura;
+
+    // Lectores por base: cantos atiende la búsqueda (su propio hilo) y la UI; biblias, los hilos de pool_capitulos
+    static constexpr size_t LECTORES_CANTOS = 2;
+    static constexpr size_t LECTORES_BIBLIAS = 2;
+
+    sqlite3* setup_db(const std::string& db_name);
+
+    // Cada una abre su base completa; `avisar` (puede estar vacío) recibe las etapas a medida que terminan
+    void abrir_cantos();
+    void abrir_biblias(const std::function<void(Apertura)>& avisar);
+    // Toma escritura_mutex; si cantos.db se está abriendo, antes espera a que termine
+    std::unique_lock<std::mutex> bloquear_escritura();
+
+    // --- ÍNDICE DE BÚSQUEDA (FTS5) ---
+    // cantos_fts tiene una fila por título (rowid = -canto_id, orden 0) y una por diapositiva
+    // (rowid = id de la diapositiva). unicode61 con remove_diacritics ignora acentos y mayúsculas.
+    void preparar_indice_fts();
+
+    // --- LISTAS DE SERVICIO ---
+    // Cada lista guarda sus elementos en orden; un elemento es un canto (canto_id) o una lectura
+    // escrita como la teclea el operador (referencia), que se resuelve al precargar.
+    void preparar_listas_servicio();
+
+    bool indexar_titulo_fts(int canto_id, const std::string& titulo);
+    // Quita del índice el título y las diapositivas actuales del canto (antes de borrarlas de la tabla)
+    bool desindexar_canto_fts(int canto_id);
+    // Debe llamarse con escritura_mutex tomado y dentro de una Transaccion
+    bool insert_diapositivas_intern(int canto_id, const std::string& letra, size_t* insertadas = nullptr);
+    bool insert_canto_intern(const std::string& titulo, const std::string& categoria, int& out_id);
+
+    // Presupuesto del cache de capítulos: EASYPRESENTER_CACHE_MB (por defecto 64 MB)
+    static size_t presupuesto_cache_capitulos();
+
+    void procesar_versiones();
+    // Del paquete si está abierto; si no, de la tabla capitulos_meta de biblias.db, que se crea
+    // la primera vez con un único recorrido de versiculos. Devuelve el origen para el log.
+    std::string cargar_metadatos_biblias();
+    // Según los metadatos, ¿el capítulo existe y tiene versículos? Sin metadatos se asume que sí.
+    bool existe_capitulo(const CacheKey& key) const;
+
+public:
+    // Según directorio_datos.h; informa en la consola de dónde salió
+    static std::string directorio_por_defecto();
+    // Carpeta de las bases, con '/' al final (multimedia.db también vive aquí)
+    const std::string& directorio_datos() const { return directorio; }
+
+    // No abre nada: hay que llamar a abrir() o a abrir_en_segundo_plano()
+    explicit AppState(DespachadorUI despachar, std::string datos = directorio_por_defecto());
+    ~AppState();
+    AppState(const AppState&) = delete;
+    AppState& operator=(const AppState&) = delete;
+
+    // Abre (o crea) cantos.db y biblias.db en este hilo
+    void abrir();
+    // Abre cantos.db y biblias.db en dos hilos a la vez y devuelve enseguida. `al_avanzar` se ejecuta
+    // con el DespachadorUI al terminar cada etapa. Mientras tanto todo se puede llamar: las lecturas
+    // devuelven vacío y las escrituras en cantos.db esperan a que termine de abrirse.
+    void abrir_en_segundo_plano(std::function<void(Apertura)> al_avanzar);
+
+    std::vector<CantoDB> get_all_cantos();
+    // Búsqueda por título y letra. Con 1-2 caracteres solo se miran los títulos (orden alfabético),
+    // porque un prefijo tan corto coincide con casi todo el índice. Desde 3 se ordena por bm25 y cada
+    // canto aparece una vez con la diapositiva que mejor coincidió; si la consulta es tan genérica que
+    // supera MAX_RANKEADAS filas ("dios", "señor"), se rankean solo los títulos y el resto se completa
+    // con diapositivas sin ordenar, para que el costo no crezca con el tamaño de la biblioteca.
+    std::vector<CoincidenciaCanto> get_cantos_filtrados(const std::string& busqueda, size_t limite = 100);
+    std::string get_canto_titulo(int id);
+    std::vector<Diapositiva> get_canto_diapositivas(int canto_id);
+    void add_canto(const std::string& titulo, const std::string& letra);
+    void update_canto(int id, const std::string& titulo, const std::string& letra);
+    void delete_canto(int id);
+
+    // Importación masiva: los cantos se escriben en lotes de `tamano_lote` por transacción,
+    // reutilizando las mismas sentencias. Un canto que falla se deshace solo (ninguno queda a
+    // medias) y cuenta en `fallidos`; si falla el COMMIT de un lote, cuenta el lote entero.
+    ResultadoImportacion importar_cantos(const std::vector<CantoImportado>& cantos, size_t tamano_lote = 1000);
+
+    // La lista de servicio más reciente; la primera vez se crea una vacía. 0 si la base no está disponible.
+    int get_lista_servicio();
+    std::vector<ElementoLista> get_elementos_lista(int lista_id);
+    // Reemplaza los elementos de la lista en una sola transacción
+    bool guardar_elementos_lista(int lista_id, const std::vector<ElementoLista>& elementos);
+    // Resuelve cada elemento con sus diapositivas: los cantos desde cantos.db y las lecturas desde el
+    // cache de capítulos (o el paquete / biblias.db) en la versión `version_id`. Se llama desde un hilo
+    // de fondo. Un elemento que ya no existe queda sin diapositivas, para no mover los índices de la lista.
+    std::vector<ContenidoElemento> materializar_lista(const std::vector<ElementoLista>& elementos, int version_id);
+
+    std::vector<VersionInfo> get_versiones() { return biblias_listas ? versiones_cargadas : std::vector<VersionInfo>{}; }
+    int get_current_version_id() { return current_version_id; }
+    // Busca por el Nombre Completo
+    std::string set_version_by_name(const std::string& name);
+    // Libros de la versión actual, ya calculados al abrir (no consulta la base)
+    const std::vector<LibroBiblia>& get_libros_biblia() const;
+
+    EstadisticasSentencias get_estadisticas_sentencias();
+    EstadisticasPool get_estadisticas_lectores();
+
+    // Lee el capítulo sin pasar por el cache
+    Capitulo leer_capitulo(const CacheKey& key);
+    // Capítulo del cache o, si no está, leído en este mismo hilo (para trabajos de fondo)
+    CapituloPtr get_capitulo(const CacheKey& key);
+    // Precarga en segundo plano lo que el operador suele pedir después de `key`: el capítulo
+    // anterior y el siguiente en la misma versión, y el mismo capítulo en las versiones de mayor
+    // prioridad. Las precargas anteriores que no empezaron se descartan, ceden el turno a cualquier
+    // carga de primer plano y entran al cache como especulativas (se expulsan primero si no se usan).
+    void precargar_vecinos(const CacheKey& key);
+    // Debe llamarse desde el hilo de la UI. Si el capítulo está en cache, `callback` se ejecuta
+    // dentro de esta misma llamada; si no, se lee en el pool y se entrega con el DespachadorUI,
+    // salvo que entretanto se haya pedido otro capítulo (en ese caso se descarta).
+    // El capítulo se comparte con el cache sin copiarse.
+    void get_capitulo_async(int libro_numero, int capitulo, std::function<void(CapituloPtr)> callback);
+
+    EstadisticasCache get_estadisticas_cache() { return chapter_cache.get_estadisticas(); }
+    // Descarta todos los capítulos del cache (las precargas en curso pueden volver a llenarlo)
+    void vaciar_cache_capitulos() { chapter_cache.vaciar(); }
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// Tiempo de arranque, para seguirlo entre versiones: desde que empezó el proceso hasta el primer cuadro
+// de la ventana principal y hasta que llegaron todos los hitos esperados (bases abiertas, lista de cantos,
+// libros, lista de servicio). Se informa una sola vez en la consola y, con EASYPRESENTER_ARRANQUE=<archivo.csv>,
+// se agrega una fila al archivo. Se usa solo desde el hilo de la interfaz.
+class MedicionArranque {
+private:
+    using Reloj = std::chrono::steady_clock;
+    Reloj::time_point inicio;
+    std::vector<std::pair<std::string, double>> hitos; // ms desde el inicio; < 0 mientras no llega
+    double primer_cuadro = -1, completo = -1;
+
+    // Lo que lleva vivo el proceso según el kernel (starttime de /proc/self/stat, con resolución de un
+    // tick): así cuenta también la carga del ejecutable y los constructores estáticos. 0 si no se sabe.
+    static double edad_proceso_ms() {
+#if defined(__linux__)
+        std::ifstream f("/proc/self/stat"); std::string linea; std::getline(f, linea);
+        size_t fin_nombre = linea.rfind(')'); if (fin_nombre == std::string::npos) return 0;
+        // Después del nombre viene el campo 3; starttime es el 22
+        std::istringstream campos(linea.substr(fin_nombre + 1)); std::string campo; unsigned long long ticks = 0;
+        for (int i = 3; i < 22; ++i) campos >> campo;
+        timespec ahora{};
+        if (!(campos >> ticks) || clock_gettime(CLOCK_BOOTTIME, &ahora) != 0) return 0;
+        double ms = (ahora.tv_sec + ahora.tv_nsec / 1e9 - static_cast<double>(ticks) / sysconf(_SC_CLK_TCK)) * 1000.0;
+        return ms > 0 ? ms : 0;
+#else
+        return 0;
+#endif
+    }
+
+    // true la única vez que queda todo medido
+    bool comprobar() {
+        if (completo < 0) {
+            double ultimo = 0;
+            for (const auto& [nombre, ms] : hitos) { if (ms < 0) return false; ultimo = std::max(ultimo, ms); }
+            completo = ultimo;
+        }
+        if (primer_cuadro < 0) return false;
+        informar(); return true;
+    }
+
+    void informar() const {
+        std::cout << std::fixed << std::setprecision(1) << "[Arranque] Primer cuadro: " << primer_cuadro << " ms | Todo cargado: " << completo << " ms (";
+        for (size_t i = 0; i < hitos.size(); ++i) std::cout << (i ? ", " : "") << hitos[i].first << " " << hitos[i].second;
+        std::cout << ")" << std::defaultfloat << std::endl;
+
+        const char* ruta = std::getenv("EASYPRESENTER_ARRANQUE"); if (!ruta || !*ruta) return;
+        std::error_code ec; bool nuevo = !std::filesystem::exists(ruta, ec);
+        std::ofstream csv(ruta, std::ios::app);
+        if (!csv) { std::cerr << "[Arranque] No se pudo escribir " << ruta << std::endl; return; }
+        if (nuevo) { csv << "fecha,primer_cuadro_ms,completo_ms"; for (const auto& h : hitos) csv << "," << h.first << "_ms"; csv << "\n"; }
+        std::time_t t = std::time(nullptr); std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &t);
+#else
+        localtime_r(&t, &local);
+#endif
+        csv << std::put_time(&local, "%Y-%m-%dT%H:%M:%S") << std::fixed << std::setprecision(1) << "," << primer_cuadro << "," << completo;
+        for (const auto& h : hitos) csv << "," << h.second;
+        csv << "\n";
+    }
+
+public:
+    // Construir lo antes posible en main; los nombres de `esperados` no deben llevar comas
+    explicit MedicionArranque(const std::vector<std::string>& esperados)
+        : inicio(Reloj::now() - std::chrono::duration_cast<Reloj::duration>(std::chrono::duration<double, std::milli>(edad_proceso_ms()))) {
+        for (const auto& nombre : esperados) hitos.emplace_back(nombre, -1);
+    }
+
+    double ms() const { return std::chrono::duration<double, std::milli>(Reloj::now() - inicio).count(); }
+    bool terminada() const { return primer_cuadro >= 0 && completo >= 0; }
+
+    // Cada una devuelve true solo en la llamada que completa la medición; las repeticiones y los
+    // nombres que no se esperan se ignoran, así que se pueden llamar en cada cuadro o en cada búsqueda.
+    bool marcar(const std::string& hito) {
+        if (terminada()) return false;
+        for (auto& [nombre, ms_hito] : hitos) if (nombre == hito && ms_hito < 0) { ms_hito = ms(); return comprobar(); }
+        return false;
+    }
+    bool marcar_primer_cuadro() {
+        if (primer_cuadro >= 0) return false;
+        primer_cuadro = ms(); return comprobar();
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Búsqueda en un hilo propio con "debounce": las pulsaciones que llegan dentro de la ventana
+// de espera se agrupan y solo se consulta el último texto. Cada búsqueda recibe una generación;
+// los resultados de una generación que ya no es la vigente se descartan sin entregarse.
+// `entrega` se llama en el hilo de trabajo: quien la recibe debe pasarla al hilo de la UI
+// y volver a comprobar es_vigente() allí, porque pudo llegar otra tecla entretanto.
+template <typename Resultado>
+class BusquedaDiferida {
+public:
+    using Consulta = std::function<Resultado(const std::string&)>;
+    using Entrega = std::function<void(uint64_t generacion, Resultado)>;
+
+private:
+    Consulta consulta;
+    Entrega entrega;
+    std::chrono::milliseconds espera;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::string texto_pendiente;
+    std::chrono::steady_clock::time_point plazo;
+    bool hay_pendiente = false;
+    bool detener = false;
+    std::atomic<uint64_t> generacion{0};
+    std::thread hilo;
+
+    void bucle() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [this] { return detener || hay_pendiente; });
+            if (detener) return;
+            // Esperamos a que el operador deje de escribir: cada tecla nueva mueve el plazo
+            while (!detener && std::chrono::steady_clock::now() < plazo) cv.wait_until(lock, plazo);
+            if (detener) return;
+            std::string texto = std::move(texto_pendiente); uint64_t gen = generacion.load();
+            hay_pendiente = false;
+            lock.unlock();
+            Resultado res = consulta(texto);
+            if (es_vigente(gen)) entrega(gen, std::move(res));
+            lock.lock();
+        }
+    }
+
+public:
+    BusquedaDiferida(Consulta fn_consulta, Entrega fn_entrega, std::chrono::milliseconds ventana = std::chrono::milliseconds(120))
+        : consulta(std::move(fn_consulta)), entrega(std::move(fn_entrega)), espera(ventana), hilo([this] { bucle(); }) {}
+    BusquedaDiferida(const BusquedaDiferida&) = delete;
+    BusquedaDiferida& operator=(const BusquedaDiferida&) = delete;
+    ~BusquedaDiferida() {
+        { std::lock_guard<std::mutex> lock(mtx); detener = true; }
+        cv.notify_all(); hilo.join();
+    }
+
+    // Encola una búsqueda y devuelve su generación. `inmediata` salta la ventana de espera
+    // (carga inicial, recarga tras guardar o borrar un canto).
+    uint64_t buscar(std::string texto, bool inmediata = false) {
+        uint64_t gen;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            texto_pendiente = std::move(texto); hay_pendiente = true;
+            plazo = std::chrono::steady_clock::now() + (inmediata ? std::chrono::milliseconds(0) : espera);
+            gen = ++generacion;
+        }
+        cv.notify_all(); return gen;
+    }
+
+    bool es_vigente(uint64_t gen) const { return gen == generacion.load(); }
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+struct EstadisticasCache { uint64_t aciertos = 0; uint64_t fallos = 0; uint64_t expulsiones = 0; uint64_t precargas = 0; uint64_t precargas_usadas = 0; size_t entradas = 0; size_t bytes = 0; size_t presupuesto = 0; };
+
+// Cache LRU con presupuesto en bytes. Los valores se guardan como shared_ptr<const Valor>:
+// un acierto solo copia el puntero y el dato sigue vivo mientras alguien lo use,
+// aunque el cache lo haya expulsado. Es seguro usarlo desde varios hilos.
+//
+// Las inserciones especulativas (precargas) van a un segmento aparte, de a lo sumo 1/4 del presupuesto:
+// una precarga nueva expulsa primero a la precarga sin usar más vieja, y una inserción normal expulsa
+// primero a las entradas usadas más frías. Así, con el cache lleno, las precargas recientes sobreviven
+// hasta que se piden (y pasan a la lista normal) o las reemplazan otras precargas.
+template <typename Clave, typename Valor, typename Hash = std::hash<Clave>>
+class CacheLRU {
+public:
+    using Ptr = std::shared_ptr<const Valor>;
+
+private:
+    struct Entrada { Clave clave; Ptr valor; size_t bytes; bool especulativa; };
+    using Lista = std::list<Entrada>;
+    static constexpr size_t FRACCION_ESPECULATIVA = 4;
+    mutable std::mutex mtx;
+    Lista orden;          // usadas; frente = usada más recientemente
+    Lista especulativas;  // precargas que nadie pidió todavía; frente = la más reciente
+    std::unordered_map<Clave, typename Lista::iterator, Hash> indice;
+    size_t presupuesto;
+    size_t bytes_usados = 0;
+    size_t bytes_especulativas = 0;
+    EstadisticasCache stats;
+
+    size_t limite_especulativas() const { return presupuesto / FRACCION_ESPECULATIVA; }
+
+    void quitar(typename Lista::iterator it) {
+        bytes_usados -= it->bytes; if (it->especulativa) bytes_especulativas -= it->bytes;
+        indice.erase(it->clave); (it->especulativa ? especulativas : orden).erase(it);
+    }
+    void expulsar(Lista& lista) { quitar(std::prev(lista.end())); stats.expulsiones++; }
+
+    // Primero las usadas más frías; las precargas solo si ya no queda ninguna usada
+    void expulsar_hasta(size_t limite) {
+        while (bytes_usados > limite && !(orden.empty() && especulativas.empty())) expulsar(orden.empty() ? especulativas : orden);
+    }
+
+public:
+    explicit CacheLRU(size_t presupuesto_bytes) : presupuesto(presupuesto_bytes) {}
+
+    Ptr buscar(const Clave& clave) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = indice.find(clave);
+        if (it == indice.end()) { stats.fallos++; return nullptr; }
+        stats.aciertos++;
+        if (it->second->especulativa) {
+            it->second->especulativa = false; bytes_especulativas -= it->second->bytes; stats.precargas_usadas++;
+            orden.splice(orden.begin(), especulativas, it->second);
+        } else orden.splice(orden.begin(), orden, it->second);
+        return it->second->valor;
+    }
+
+    // Inserta o reemplaza. Un valor más grande que todo el presupuesto no se guarda, y una precarga
+    // más grande que su segmento tampoco. Una precarga nunca reemplaza una entrada que ya estaba.
+    void insertar(const Clave& clave, Ptr valor, size_t bytes, bool especulativa = false) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = indice.find(clave);
+        if (it != indice.end()) {
+            if (especulativa) return;
+            quitar(it->second);
+        }
+        if (bytes > (especulativa ? limite_especulativas() : presupuesto)) return;
+        if (especulativa) while (bytes_especulativas + bytes > limite_especulativas()) expulsar(especulativas);
+        expulsar_hasta(presupuesto - bytes);
+        Lista& lista = especulativa ? especulativas : orden;
+        indice[clave] = lista.insert(lista.begin(), { clave, std::move(valor), bytes, especulativa });
+        bytes_usados += bytes;
+        if (especulativa) { bytes_especulativas += bytes; stats.precargas++; }
+    }
+
+    // Descarta las entradas cuya clave cumple `condicion` (sin contarlas como expulsiones)
+    template <typename Condicion> void descartar_si(Condicion condicion) {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (Lista* lista : { &orden, &especulativas })
+            for (auto it = lista->begin(); it != lista->end();) { auto actual = it++; if (condicion(actual->clave)) quitar(actual); }
+    }
+
+    // Descarta todas las entradas; las estadísticas se conservan
+    void vaciar() { std::lock_guard<std::mutex> lock(mtx); orden.clear(); especulativas.clear(); indice.clear(); bytes_usados = bytes_especulativas = 0; }
+
+    // Consulta sin afectar el orden LRU ni las estadísticas
+    bool contiene(const Clave& clave) const { std::lock_guard<std::mutex> lock(mtx); return indice.count(clave) > 0; }
+
+    EstadisticasCache get_estadisticas() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        EstadisticasCache s = stats; s.entradas = orden.size() + especulativas.size(); s.bytes = bytes_usados; s.presupuesto = presupuesto; return s;
+    }
+};
@@ -0,0 +1,183 @@
+#pragma once
+#include <sqlite3.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct EstadisticasSentencias { uint64_t preparadas = 0; uint64_t reutilizadas = 0; };
+
+// Cache de sentencias preparadas por conexión: cada SQL se compila una sola vez
+// y en los siguientes usos solo se resetea y se vuelve a enlazar.
+class CacheSentencias {
+private:
+    struct HashSql { using is_transparent = void; std::size_t operator()(std::string_view sql) const { return std::hash<std::string_view>()(sql); } };
+    sqlite3* db = nullptr;
+    std::unordered_map<std::string, sqlite3_stmt*, HashSql, std::equal_to<>> sentencias;
+    // Atómicos: las estadísticas se suman desde otro hilo mientras la conexión está en uso
+    std::atomic<uint64_t> preparadas{0}, reutilizadas{0};
+
+public:
+    CacheSentencias() = default;
+    CacheSentencias(const CacheSentencias&) = delete;
+    CacheSentencias& operator=(const CacheSentencias&) = delete;
+    ~CacheSentencias() { finalizar(); }
+
+    void set_conexion(sqlite3* conexion) { finalizar(); db = conexion; }
+
+    sqlite3_stmt* obtener(std::string_view sql) {
+        auto it = sentencias.find(sql);
+        if (it != sentencias.end()) { reutilizadas++; return it->second; }
+        sqlite3_stmt* stmt = nullptr;
+        if (!db || sqlite3_prepare_v3(db, sql.data(), static_cast<int>(sql.size()), SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) { sqlite3_finalize(stmt); return nullptr; }
+        preparadas++; sentencias.emplace(std::string(sql), stmt); return stmt;
+    }
+
+    void finalizar() { for (auto& [sql, stmt] : sentencias) sqlite3_finalize(stmt); sentencias.clear(); }
+    EstadisticasSentencias get_estadisticas() const { return { preparadas.load(), reutilizadas.load() }; }
+};
+
+// Préstamo de una sentencia del cache: al salir del alcance queda reseteada y sin parámetros,
+// así no deja transacciones de lectura abiertas ni valores del uso anterior.
+class SentenciaUso {
+private:
+    sqlite3_stmt* stmt;
+
+public:
+    SentenciaUso(CacheSentencias& cache, std::string_view sql) : stmt(cache.obtener(sql)) {}
+    SentenciaUso(const SentenciaUso&) = delete;
+    SentenciaUso& operator=(const SentenciaUso&) = delete;
+    ~SentenciaUso() { if (stmt) { sqlite3_reset(stmt); sqlite3_clear_bindings(stmt); } }
+    operator sqlite3_stmt*() const { return stmt; }
+    explicit operator bool() const { return stmt != nullptr; }
+};
+
+// Transacción de escritura: si no se confirma, el destructor hace ROLLBACK.
+// Así un canto nunca queda con solo parte de sus diapositivas.
+class Transaccion {
+private:
+    sqlite3* db; bool activa = false;
+
+public:
+    explicit Transaccion(sqlite3* conexion) : db(conexion) { activa = db && sqlite3_exec(db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) == SQLITE_OK; }
+    Transaccion(const Transaccion&) = delete;
+    Transaccion& operator=(const Transaccion&) = delete;
+    ~Transaccion() { if (activa) sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr); }
+    explicit operator bool() const { return activa; }
+    bool confirmar() {
+        if (!activa) return false;
+        if (sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) return false;
+        activa = false; return true;
+    }
+};
+
+// Punto de guardado dentro de una Transaccion: si no se confirma, el destructor deshace solo lo hecho
+// desde que se creó (ROLLBACK TO) y la transacción sigue. Sirve para descartar un elemento de un lote.
+class PuntoGuardado {
+private:
+    sqlite3* db; bool activo = false;
+
+public:
+    explicit PuntoGuardado(sqlite3* conexion) : db(conexion) { activo = db && sqlite3_exec(db, "SAVEPOINT elemento", nullptr, nullptr, nullptr) == SQLITE_OK; }
+    PuntoGuardado(const PuntoGuardado&) = delete;
+    PuntoGuardado& operator=(const PuntoGuardado&) = delete;
+    ~PuntoGuardado() { if (activo) sqlite3_exec(db, "ROLLBACK TO elemento; RELEASE elemento", nullptr, nullptr, nullptr); }
+    explicit operator bool() const { return activo; }
+    bool confirmar() {
+        if (!activo) return false;
+        if (sqlite3_exec(db, "RELEASE elemento", nullptr, nullptr, nullptr) != SQLITE_OK) return false;
+        activo = false; return true;
+    }
+};
+
+// Una conexión con su cache de sentencias. La usa un solo hilo a la vez.
+struct ConexionSqlite {
+    sqlite3* db = nullptr;
+    CacheSentencias sql;
+
+    ConexionSqlite() = default;
+    ConexionSqlite(const ConexionSqlite&) = delete;
+    ConexionSqlite& operator=(const ConexionSqlite&) = delete;
+    ~ConexionSqlite() { sql.finalizar(); if (db) sqlite3_close(db); }
+};
+
+struct EstadisticasPool { uint64_t prestamos = 0; uint64_t esperas = 0; size_t conexiones = 0; };
+
+// Pool de conexiones de solo lectura a una base en modo WAL. Cada lector trabaja sobre su propia
+// conexión (SQLITE_OPEN_NOMUTEX: el pool garantiza que no se comparte), así las lecturas no se
+// esperan entre sí ni esperan a la conexión de escritura. Si todas están prestadas, prestar()
+// espera a que se devuelva una.
+class PoolLectura {
+private:
+    std::vector<std::unique_ptr<ConexionSqlite>> conexiones;
+    std::vector<ConexionSqlite*> libres;
+    std::mutex mtx;
+    std::condition_variable cv;
+    EstadisticasPool stats;
+
+    void devolver(ConexionSqlite* c) {
+        { std::lock_guard<std::mutex> lock(mtx); libres.push_back(c); }
+        cv.notify_one();
+    }
+
+public:
+    // Préstamo de una conexión: se devuelve al pool al salir del alcance
+    class Prestamo {
+    private:
+        PoolLectura* pool = nullptr; ConexionSqlite* con = nullptr;
+
+    public:
+        Prestamo(PoolLectura* p, ConexionSqlite* c) : pool(p), con(c) {}
+        Prestamo(Prestamo&& o) noexcept : pool(o.pool), con(o.con) { o.con = nullptr; }
+        Prestamo(const Prestamo&) = delete;
+        Prestamo& operator=(const Prestamo&) = delete;
+        Prestamo& operator=(Prestamo&&) = delete;
+        ~Prestamo() { if (con) pool->devolver(con); }
+        ConexionSqlite* operator->() const { return con; }
+        explicit operator bool() const { return con != nullptr; }
+    };
+
+    PoolLectura() = default;
+    PoolLectura(const PoolLectura&) = delete;
+    PoolLectura& operator=(const PoolLectura&) = delete;
+
+    // Abre `cantidad` conexiones de solo lectura; false si no se pudo abrir ninguna
+    bool abrir(const std::string& ruta, size_t cantidad) {
+        cerrar();
+        std::lock_guard<std::mutex> lock(mtx);
+        for (size_t i = 0; i < cantidad; ++i) {
+            auto c = std::make_unique<ConexionSqlite>();
+            if (sqlite3_open_v2(ruta.c_str(), &c->db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) break;
+            c->sql.set_conexion(c->db);
+            libres.push_back(c.get()); conexiones.push_back(std::move(c));
+        }
+        stats.conexiones = conexiones.size();
+        return !conexiones.empty();
+    }
+
+    // Solo con todas las conexiones devueltas (al cerrar la aplicación)
+    void cerrar() { std::lock_guard<std::mutex> lock(mtx); libres.clear(); conexiones.clear(); stats.conexiones = 0; }
+    bool abierto() { std::lock_guard<std::mutex> lock(mtx); return !conexiones.empty(); }
+
+    // Préstamo vacío (falso) si el pool no tiene conexiones
+    Prestamo prestar() {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (conexiones.empty()) return { this, nullptr };
+        stats.prestamos++;
+        if (libres.empty()) { stats.esperas++; cv.wait(lock, [this] { return !libres.empty(); }); }
+        ConexionSqlite* c = libres.back(); libres.pop_back();
+        return { this, c };
+    }
+
+    EstadisticasSentencias get_estadisticas_sentencias() {
+        std::lock_guard<std::mutex> lock(mtx); EstadisticasSentencias total;
+        for (const auto& c : conexiones) { auto s = c->sql.get_estadisticas(); total.preparadas += s.preparadas; total.reutilizadas += s.reutilizadas; }
+        return total;
+    }
+    EstadisticasPool get_estadisticas() { std::lock_guard<std::mutex> lock(mtx); return stats; }
+};
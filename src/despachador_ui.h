@@ -0,0 +1,6 @@
+#pragma once
+#include <functional>
+
+// Entrega un trabajo al hilo de la interfaz. La app usa slint::invoke_from_event_loop; sin interfaz
+// (bench_easypresenter) se puede ejecutar en el mismo hilo que lo entrega.
+using DespachadorUI = std::function<void(std::function<void()>)>;
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Carpeta de las bases (cantos.db, biblias.db, biblias.pack, multimedia.db). Se busca en este orden:
+//   1. la variable EASYPRESENTER_DATOS
+//   2. "datos = <carpeta>" en $XDG_CONFIG_HOME/easypresenter/config (~/.config/easypresenter/config)
+//   3. $XDG_DATA_HOME/easypresenter (~/.local/share/easypresenter), si ya tiene cantos.db
+//   4. la carpeta de desarrollo (data/ del árbol con el que se compiló), si tiene cantos.db
+//   5. $XDG_DATA_HOME/easypresenter, aunque esté vacía: AppState la crea
+// En Windows, si no hay variables XDG, la configuración y los datos van en %APPDATA%\easypresenter.
+namespace directorio_datos {
+
+struct Resuelto { std::filesystem::path carpeta; const char* origen; };
+
+inline std::string recortar(const std::string& s) {
+    size_t a = s.find_first_not_of(" \t\r\n"); if (a == std::string::npos) return "";
+    return s.substr(a, s.find_last_not_of(" \t\r\n") - a + 1);
+}
+
+// $HOME; en Windows, si no está definida, %USERPROFILE%
+inline const char* carpeta_personal() {
+    const char* home = std::getenv("HOME");
+#ifdef _WIN32
+    if (!home || !*home) home = std::getenv("USERPROFILE");
+#endif
+    return home && *home ? home : nullptr;
+}
+
+// "~/..." -> $HOME/...
+inline std::filesystem::path expandir(const std::string& ruta) {
+    const char* home = carpeta_personal();
+    if (home && (ruta == "~" || ruta.rfind("~/", 0) == 0)) return std::filesystem::path(home) / ruta.substr(ruta.size() > 1 ? 2 : 1);
+    return ruta;
+}
+
+// $XDG_<variable> o, si no está definida, $HOME/<por_defecto> (%APPDATA% en Windows)
+inline std::filesystem::path xdg(const char* variable, const char* por_defecto) {
+    if (const char* v = std::getenv(variable); v && *v) return v;
+#ifdef _WIN32
+    if (const char* appdata = std::getenv("APPDATA"); appdata && *appdata) return appdata;
+#endif
+    const char* home = carpeta_personal();
+    return home ? std::filesystem::path(home) / por_defecto : std::filesystem::path(por_defecto);
+}
+
+inline std::filesystem::path archivo_config() { return xdg("XDG_CONFIG_HOME", ".config") / "easypresenter" / "config"; }
+
+// Valor de "datos" en el archivo de configuración ("clave = valor" por línea, '#' comenta); vacío si no está
+inline std::string leer_config() {
+    std::ifstream f(archivo_config()); std::string linea;
+    while (std::getline(f, linea)) {
+        linea = recortar(linea.substr(0, linea.find('#')));
+        size_t igual = linea.find('=');
+        if (igual != std::string::npos && recortar(linea.substr(0, igual)) == "datos") return recortar(linea.substr(igual + 1));
+    }
+    return "";
+}
+
+inline Resuelto resolver(const std::filesystem::path& desarrollo = {}) {
+    std::error_code ec;
+    if (const char* env = std::getenv("EASYPRESENTER_DATOS"); env && *env) return { expandir(env), "EASYPRESENTER_DATOS" };
+    if (std::string config = leer_config(); !config.empty()) return { expandir(config), "config" };
+    std::filesystem::path usuario = xdg("XDG_DATA_HOME", ".local/share") / "easypresenter";
+    if (std::filesystem::exists(usuario / "cantos.db", ec)) return { usuario, "XDG_DATA_HOME" };
+    if (!desarrollo.empty() && std::filesystem::exists(desarrollo / "cantos.db", ec)) return { desarrollo, "desarrollo" };
+    return { usuario, "XDG_DATA_HOME (nueva)" };
+}
+
+} // namespace directorio_datos
@@ -0,0 +1,180 @@
+#pragma once
+#include "cache_lru.h"
+#include "despachador_ui.h"
+#include "multimedia.h"
+#include "pool_trabajo.h"
+#include "traza.h"
+#include <slint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Fondo ya escalado para un tamaño de proyector
+struct ClaveFondo {
+    int imagen_id; uint32_t ancho; uint32_t alto;
+    bool operator==(const ClaveFondo& o) const { return imagen_id == o.imagen_id && ancho == o.ancho && alto == o.alto; }
+};
+struct ClaveFondoHash {
+    std::size_t operator()(const ClaveFondo& k) const { return std::hash<uint64_t>()((static_cast<uint64_t>(k.imagen_id) << 32) ^ (static_cast<uint64_t>(k.ancho) << 16) ^ k.alto); }
+};
+
+// Píxeles decodificados, listos para slint::Image. slint::Image no se puede usar fuera del hilo de la
+// interfaz: los hilos de la galería y el cache solo manejan estos buffers.
+using Pixeles = slint::SharedPixelBuffer<slint::Rgba8Pixel>;
+using PixelesPtr = std::shared_ptr<const Pixeles>;
+
+// Imágenes de multimedia.db para la interfaz: fondos del proyector y miniaturas de la galería.
+// Todo lo que cuesta (abrir la base, leer y decodificar archivos, escalar, generar miniaturas) corre en
+// el pool; cada imagen se decodifica directo en un SharedPixelBuffer y el hilo de la interfaz recibe un
+// puntero a él: ahí se arma el slint::Image (comparte los píxeles, no los copia). Los fondos quedan en un
+// cache LRU por tamaño de proyector: volver a uno ya usado es un acierto y no se decodifica de nuevo.
+class GaleriaImagenes {
+private:
+    Multimedia multimedia;
+    DespachadorUI despachar_ui;
+    CacheLRU<ClaveFondo, Pixeles, ClaveFondoHash> fondos{presupuesto_cache_fondos()};
+    // Solo se entrega el fondo de la petición más reciente
+    std::shared_ptr<std::atomic<uint64_t>> generacion_fondo = std::make_shared<std::atomic<uint64_t>>(0);
+    // Imágenes quitadas: sus miniaturas, fondos y precargas pendientes se saltan. `sin_borrar` son las que
+    // todavía esperan su DELETE en el pool; si la app se cierra antes, se borran en el destructor.
+    std::mutex quitadas_mtx;
+    std::unordered_set<int> quitadas;
+    std::vector<int> sin_borrar;
+    PoolTrabajo pool{2}; // fondos pedidos (primer plano); precargas y miniaturas (segundo plano)
+
+    // Presupuesto del cache de fondos: EASYPRESENTER_CACHE_IMAGENES_MB (por defecto 192 MB, unos 23 fondos de 1920x1080)
+    static size_t presupuesto_cache_fondos() {
+        const char* mb = std::getenv("EASYPRESENTER_CACHE_IMAGENES_MB");
+        long valor = mb ? std::strtol(mb, nullptr, 10) : 0;
+        return static_cast<size_t>(valor > 0 ? valor : 192) * 1024 * 1024;
+    }
+
+    // Decodifica en un buffer de Slint; nullptr si no se pudo
+    static PixelesPtr decodificar(const std::function<imagenes::Resultado(const imagenes::Reservar&)>& decodificador, const std::string& nombre) {
+        Pixeles buffer;
+        auto r = decodificador([&buffer](uint32_t ancho, uint32_t alto) {
+            buffer = Pixeles(ancho, alto);
+            return reinterpret_cast<uint8_t*>(buffer.begin());
+        });
+        if (!r.ok) { std::cerr << "[Imágenes] " << nombre << ": " << r.error << std::endl; return nullptr; }
+        return std::make_shared<const Pixeles>(std::move(buffer));
+    }
+
+    PixelesPtr decodificar_fondo(const ElementoMultimedia& imagen, const ClaveFondo& clave) {
+        traza::Medicion m(traza::Etapa::Ajuste, "decodificar fondo");
+        return decodificar([&](const imagenes::Reservar& reservar) {
+            return imagenes::decodificar_archivo(imagen.ruta, clave.ancho, clave.alto, imagenes::ajuste_desde_texto(imagen.aspecto), reservar);
+        }, imagen.nombre);
+    }
+
+    static size_t bytes_fondo(const ClaveFondo& clave) { return static_cast<size_t>(clave.ancho) * clave.alto * 4; }
+
+    bool quitada(int id) { std::lock_guard<std::mutex> lock(quitadas_mtx); return quitadas.count(id) > 0; }
+
+    // true si el DELETE de `id` seguía pendiente (y ahora le toca a quien llama)
+    bool tomar_borrado(int id) {
+        std::lock_guard<std::mutex> lock(quitadas_mtx);
+        auto it = std::find(sin_borrar.begin(), sin_borrar.end(), id);
+        if (it == sin_borrar.end()) return false;
+        sin_borrar.erase(it); return true;
+    }
+
+public:
+    explicit GaleriaImagenes(DespachadorUI despachar) : despachar_ui(std::move(despachar)) {}
+    ~GaleriaImagenes() {
+        pool.detener();
+        for (int id : sin_borrar) multimedia.quitar(TipoMultimedia::Imagen, id);
+    }
+    GaleriaImagenes(const GaleriaImagenes&) = delete;
+    GaleriaImagenes& operator=(const GaleriaImagenes&) = delete;
+
+    // Abre multimedia.db en el pool y entrega el catálogo de imágenes con el DespachadorUI
+    void abrir(const std::string& ruta, std::function<void(std::vector<ElementoMultimedia>)> listo) {
+        pool.encolar([this, ruta, listo = std::move(listo)]() {
+            traza::Medicion m(traza::Etapa::Consulta, "abrir multimedia.db");
+            std::vector<ElementoMultimedia> catalogo;
+            if (multimedia.abrir(ruta)) catalogo = multimedia.listar(TipoMultimedia::Imagen);
+            despachar_ui([listo, catalogo = std::move(catalogo)]() mutable { listo(std::move(catalogo)); });
+        });
+    }
+
+    // Agrega una imagen o una carpeta al catálogo (en el pool) y entrega las nuevas
+    void agregar(const std::string& ruta, std::function<void(std::vector<ElementoMultimedia>)> listo) {
+        pool.encolar([this, ruta, listo = std::move(listo)]() {
+            auto nuevas = multimedia.agregar_imagenes(ruta);
+            despachar_ui([listo, nuevas = std::move(nuevas)]() mutable { listo(std::move(nuevas)); });
+        });
+    }
+
+    // Saca la imagen del catálogo (el archivo no se toca) en el pool, porque multimedia.db puede estar
+    // ocupada con una importación, y entrega el resultado con el DespachadorUI. Desde ya se saltan su
+    // miniatura, su fondo y sus precargas pendientes, y sus fondos salen del cache; si falla, vuelve a estar
+    // disponible. Si la app se cierra antes de que corra, el destructor la borra igual.
+    void quitar(int id, std::function<void(bool)> listo) {
+        { std::lock_guard<std::mutex> lock(quitadas_mtx); quitadas.insert(id); sin_borrar.push_back(id); }
+        fondos.descartar_si([id](const ClaveFondo& clave) { return clave.imagen_id == id; });
+        pool.encolar([this, id, listo = std::move(listo)]() {
+            if (!tomar_borrado(id)) return;
+            bool ok = multimedia.quitar(TipoMultimedia::Imagen, id);
+            if (!ok) { std::lock_guard<std::mutex> lock(quitadas_mtx); quitadas.erase(id); }
+            despachar_ui([listo, ok]() { listo(ok); });
+        });
+    }
+
+    // Miniaturas de `lista`, una por una en segundo plano (las guardadas se leen; las que faltan se
+    // generan y se guardan). Cada una se entrega con el DespachadorUI en cuanto está.
+    void miniaturas(std::vector<ElementoMultimedia> lista, std::function<void(int id, PixelesPtr)> lista_una) {
+        for (auto& imagen : lista) {
+            pool.encolar([this, imagen = std::move(imagen), lista_una]() {
+                if (quitada(imagen.id)) return;
+                traza::Medicion m(traza::Etapa::Ajuste, "miniatura");
+                auto miniatura = decodificar([&](const imagenes::Reservar& reservar) { return multimedia.miniatura(imagen, reservar); }, imagen.nombre);
+                if (miniatura) despachar_ui([lista_una, id = imagen.id, miniatura]() { lista_una(id, miniatura); });
+            }, PoolTrabajo::Prioridad::SegundoPlano);
+        }
+    }
+
+    // Debe llamarse desde el hilo de la UI. Si el fondo ya está a ese tamaño, `listo` se ejecuta dentro de
+    // esta llamada; si no, se decodifica en el pool y se entrega con el DespachadorUI, salvo que entretanto
+    // se haya pedido otro fondo.
+    void fondo(const ElementoMultimedia& imagen, uint32_t ancho, uint32_t alto, std::function<void(PixelesPtr)> listo) {
+        ClaveFondo clave{ imagen.id, ancho, alto };
+        uint64_t gen = ++*generacion_fondo;
+        if (auto cacheado = fondos.buscar(clave)) { listo(std::move(cacheado)); return; }
+        pool.encolar([this, imagen, clave, gen, listo = std::move(listo), generacion = generacion_fondo]() {
+            if (gen != *generacion || quitada(imagen.id)) return;
+            auto decodificado = fondos.buscar(clave); // pudo llegar con una precarga
+            if (!decodificado) { decodificado = decodificar_fondo(imagen, clave); if (decodificado && !quitada(imagen.id)) fondos.insertar(clave, decodificado, bytes_fondo(clave)); }
+            despachar_ui([gen, generacion, listo, decodificado, enviado = traza::marca()]() {
+                traza::registrar_desde(traza::Etapa::Salto, "fondo -> UI", enviado);
+                if (gen == *generacion) listo(decodificado);
+            });
+        });
+    }
+
+    // El fondo pedido que todavía no llegó ya no se entrega (al quitar el fondo)
+    void cancelar_fondo() { ++*generacion_fondo; }
+
+    // Deja en el cache, como especulativas, las imágenes que probablemente se pidan después (las vecinas
+    // en la galería). Ceden el paso: si hay un fondo pedido esperando, la precarga se salta.
+    void precargar(const std::vector<ElementoMultimedia>& lista, uint32_t ancho, uint32_t alto) {
+        for (const auto& imagen : lista) {
+            ClaveFondo clave{ imagen.id, ancho, alto };
+            if (fondos.contiene(clave)) continue;
+            pool.encolar([this, imagen, clave]() {
+                if (pool.pendientes(PoolTrabajo::Prioridad::PrimerPlano) > 0 || fondos.contiene(clave) || quitada(imagen.id)) return;
+                auto decodificado = decodificar_fondo(imagen, clave);
+                if (decodificado && !quitada(imagen.id)) fondos.insertar(clave, decodificado, bytes_fondo(clave), true);
+            }, PoolTrabajo::Prioridad::SegundoPlano);
+        }
+    }
+
+    EstadisticasCache get_estadisticas() { return fondos.get_estadisticas(); }
+};
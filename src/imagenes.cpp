@@ -0,0 +1,235 @@
+#include "imagenes.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <jpeglib.h>
+#include <png.h>
+
+namespace imagenes {
+
+namespace {
+
+// Más que esto no se decodifica (un PNG de 20000 x 20000 serían 1.6 GB)
+constexpr uint64_t MAX_PIXELES = 100'000'000;
+
+// Imagen decodificada antes de escalar: RGBA, o RGB si el JPEG viene de un libjpeg sin extensiones
+struct Fuente { std::vector<uint8_t> pixeles; uint32_t ancho = 0; uint32_t alto = 0; uint32_t canales = 0; };
+
+// Región de la fuente que se usa (en píxeles de la fuente, puede ser fraccionaria) y tamaño final
+struct Plan { double x0; double y0; double ancho; double alto; uint32_t destino_ancho; uint32_t destino_alto; };
+
+Plan planificar(uint32_t ancho, uint32_t alto, uint32_t max_ancho, uint32_t max_alto, Ajuste ajuste) {
+    Plan p{ 0, 0, static_cast<double>(ancho), static_cast<double>(alto), 0, 0 };
+    tamano_ajustado(ancho, alto, max_ancho, max_alto, ajuste, p.destino_ancho, p.destino_alto);
+    if (ajuste == Ajuste::Cubrir && p.destino_ancho && p.destino_alto) {
+        double escala = std::max(static_cast<double>(max_ancho) / ancho, static_cast<double>(max_alto) / alto);
+        p.ancho = std::min<double>(ancho, max_ancho / escala); p.alto = std::min<double>(alto, max_alto / escala);
+        p.x0 = (ancho - p.ancho) / 2; p.y0 = (alto - p.alto) / 2;
+    }
+    return p;
+}
+
+// Pesos de un eje. Al reducir, cada píxel de destino promedia los de la fuente que cubre (según cuánto
+// de cada uno cubre); al ampliar, interpola entre los dos más cercanos.
+struct Pesos { std::vector<uint32_t> inicio; std::vector<uint32_t> cantidad; std::vector<float> peso; uint32_t taps = 0; };
+
+Pesos calcular_pesos(double origen, double tamano, uint32_t limite, uint32_t destino) {
+    Pesos p; double escala = tamano / destino;
+    p.taps = escala > 1 ? static_cast<uint32_t>(std::ceil(escala)) + 1 : 2;
+    p.inicio.resize(destino); p.cantidad.resize(destino); p.peso.assign(static_cast<size_t>(destino) * p.taps, 0.0f);
+    for (uint32_t i = 0; i < destino; ++i) {
+        float* w = &p.peso[static_cast<size_t>(i) * p.taps];
+        if (escala > 1) {
+            double a = origen + i * escala, b = a + escala;
+            uint32_t j0 = static_cast<uint32_t>(a), j1 = std::min(limite, static_cast<uint32_t>(std::ceil(b)));
+            p.inicio[i] = j0; p.cantidad[i] = j1 - j0;
+            for (uint32_t j = j0; j < j1; ++j) w[j - j0] = static_cast<float>((std::min<double>(b, j + 1) - std::max<double>(a, j)) / escala);
+        } else {
+            double c = std::clamp(origen + (i + 0.5) * escala - 0.5, 0.0, static_cast<double>(limite - 1));
+            uint32_t j0 = static_cast<uint32_t>(c); float t = static_cast<float>(c - j0);
+            p.inicio[i] = j0;
+            if (j0 + 1 < limite) { p.cantidad[i] = 2; w[0] = 1 - t; w[1] = t; } else { p.cantidad[i] = 1; w[0] = 1; }
+        }
+    }
+    return p;
+}
+
+inline uint8_t a_byte(float v) { return static_cast<uint8_t>(std::clamp(v + 0.5f, 0.0f, 255.0f)); }
+
+// La región ya tiene el tamaño final (p. ej. un JPEG 4K reducido 1/2 en la DCT para 1920x1080): se copia
+bool copiar_sin_escalar(const Fuente& f, const Plan& plan, uint8_t* destino) {
+    uint32_t x0 = static_cast<uint32_t>(plan.x0), y0 = static_cast<uint32_t>(plan.y0);
+    if (plan.ancho != plan.destino_ancho || plan.alto != plan.destino_alto || plan.x0 != x0 || plan.y0 != y0) return false;
+    for (uint32_t y = 0; y < plan.destino_alto; ++y) {
+        const uint8_t* src = &f.pixeles[(static_cast<size_t>(y0 + y) * f.ancho + x0) * f.canales];
+        uint8_t* out = destino + static_cast<size_t>(y) * plan.destino_ancho * 4;
+        if (f.canales == 4) std::copy(src, src + static_cast<size_t>(plan.destino_ancho) * 4, out);
+        else for (uint32_t x = 0; x < plan.destino_ancho; ++x, src += 3, out += 4) { out[0] = src[0]; out[1] = src[1]; out[2] = src[2]; out[3] = 255; }
+    }
+    return true;
+}
+
+// Separable: por cada fila de destino se acumulan (con su peso) las filas de la fuente que la forman,
+// solo en las columnas que se usan, y esa fila se reduce o amplía en horizontal.
+void escalar(const Fuente& f, const Plan& plan, uint8_t* destino) {
+    if (copiar_sin_escalar(f, plan, destino)) return;
+    Pesos px = calcular_pesos(plan.x0, plan.ancho, f.ancho, plan.destino_ancho);
+    Pesos py = calcular_pesos(plan.y0, plan.alto, f.alto, plan.destino_alto);
+    uint32_t c0 = px.inicio.front(), c1 = px.inicio.back() + px.cantidad.back();
+    std::vector<float> fila(static_cast<size_t>(c1 - c0) * 4);
+    for (uint32_t y = 0; y < plan.destino_alto; ++y) {
+        std::fill(fila.begin(), fila.end(), 0.0f);
+        const float* wy = &py.peso[static_cast<size_t>(y) * py.taps];
+        for (uint32_t k = 0; k < py.cantidad[y]; ++k) {
+            const uint8_t* src = &f.pixeles[(static_cast<size_t>(py.inicio[y] + k) * f.ancho + c0) * f.canales];
+            float w = wy[k]; float* acc = fila.data();
+            if (f.canales == 4) { for (size_t i = 0; i < fila.size(); ++i) acc[i] += w * src[i]; }
+            else { for (uint32_t x = c0; x < c1; ++x, src += 3, acc += 4) { acc[0] += w * src[0]; acc[1] += w * src[1]; acc[2] += w * src[2]; acc[3] += w * 255.0f; } }
+        }
+        uint8_t* out = destino + static_cast<size_t>(y) * plan.destino_ancho * 4;
+        for (uint32_t x = 0; x < plan.destino_ancho; ++x, out += 4) {
+            const float* wx = &px.peso[static_cast<size_t>(x) * px.taps]; const float* acc = &fila[static_cast<size_t>(px.inicio[x] - c0) * 4];
+            float r = 0, g = 0, b = 0, a = 0;
+            for (uint32_t k = 0; k < px.cantidad[x]; ++k, acc += 4) { r += wx[k] * acc[0]; g += wx[k] * acc[1]; b += wx[k] * acc[2]; a += wx[k] * acc[3]; }
+            out[0] = a_byte(r); out[1] = a_byte(g); out[2] = a_byte(b); out[3] = a_byte(a);
+        }
+    }
+}
+
+// libjpeg informa los errores llamando a error_exit, que por defecto termina el proceso: aquí se vuelve
+// con longjmp. Por eso las funciones que usan setjmp no tienen objetos de C++ propios (todo lo que tiene
+// destructor llega por referencia) y no quedan destructores salteados.
+struct ErrorJpeg { jpeg_error_mgr base; std::jmp_buf salto; char mensaje[JMSG_LENGTH_MAX]; };
+
+[[noreturn]] void salir_jpeg(j_common_ptr info) {
+    auto* e = reinterpret_cast<ErrorJpeg*>(info->err);
+    info->err->format_message(info, e->mensaje);
+    std::longjmp(e->salto, 1);
+}
+
+bool leer_jpeg(const std::vector<uint8_t>& archivo, uint32_t max_ancho, uint32_t max_alto, Ajuste ajuste, Fuente& f, std::string& error) {
+    jpeg_decompress_struct info; ErrorJpeg err;
+    info.err = jpeg_std_error(&err.base); err.base.error_exit = salir_jpeg;
+    if (setjmp(err.salto)) { jpeg_destroy_decompress(&info); error = err.mensaje; return false; }
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, archivo.data(), static_cast<unsigned long>(archivo.size()));
+    jpeg_read_header(&info, TRUE);
+    // Reducción en la DCT: la mayor que todavía deja la imagen al menos del tamaño final. libjpeg-turbo
+    // reduce en pasos de 1/8 (4K a 1280x720 decodifica a 3/8); libjpeg clásico solo a 1/2, 1/4 y 1/8.
+    Plan plan = planificar(info.image_width, info.image_height, max_ancho, max_alto, ajuste);
+    double factor = plan.destino_ancho && plan.destino_alto ? std::max(plan.destino_ancho / plan.ancho, plan.destino_alto / plan.alto) : 1.0;
+    info.scale_num = 1; info.scale_denom = 1;
+#ifdef LIBJPEG_TURBO_VERSION
+    for (unsigned n = 1; n < 8; ++n) if (factor * 8 <= n) { info.scale_num = n; info.scale_denom = 8; break; }
+#else
+    for (unsigned d : { 8u, 4u, 2u }) if (factor * d <= 1.0) { info.scale_denom = d; break; }
+#endif
+    // Con las extensiones de libjpeg-turbo sale ya en RGBA, el formato de destino
+#ifdef JCS_EXTENSIONS
+    info.out_color_space = JCS_EXT_RGBA; f.canales = 4;
+#else
+    info.out_color_space = JCS_RGB; f.canales = 3;
+#endif
+    jpeg_start_decompress(&info);
+    if (static_cast<uint64_t>(info.output_width) * info.output_height > MAX_PIXELES) { jpeg_destroy_decompress(&info); error = "imagen demasiado grande"; return false; }
+    f.ancho = info.output_width; f.alto = info.output_height;
+    f.pixeles.resize(static_cast<size_t>(f.ancho) * f.alto * f.canales);
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW fila = &f.pixeles[static_cast<size_t>(info.output_scanline) * f.ancho * f.canales];
+        jpeg_read_scanlines(&info, &fila, 1);
+    }
+    jpeg_finish_decompress(&info); jpeg_destroy_decompress(&info);
+    return true;
+}
+
+// API simplificada de libpng: maneja sus errores sin setjmp
+bool leer_png(const std::vector<uint8_t>& archivo, Fuente& f, std::string& error) {
+    png_image img{}; img.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&img, archivo.data(), archivo.size())) { error = img.message; return false; }
+    if (static_cast<uint64_t>(img.width) * img.height > MAX_PIXELES) { png_image_free(&img); error = "imagen demasiado grande"; return false; }
+    img.format = PNG_FORMAT_RGBA;
+    f.ancho = img.width; f.alto = img.height; f.canales = 4; f.pixeles.resize(PNG_IMAGE_SIZE(img));
+    if (!png_image_finish_read(&img, nullptr, f.pixeles.data(), 0, nullptr)) { error = img.message; png_image_free(&img); return false; }
+    return true;
+}
+
+// Lo que devuelve jpeg_mem_dest (reservado con malloc); lo libera quien llama
+struct SalidaJpeg { unsigned char* datos = nullptr; unsigned long tamano = 0; };
+
+bool comprimir_jpeg(const uint8_t* rgba, uint32_t ancho, uint32_t alto, int calidad, std::vector<uint8_t>& fila, SalidaJpeg& salida) {
+    jpeg_compress_struct info; ErrorJpeg err;
+    info.err = jpeg_std_error(&err.base); err.base.error_exit = salir_jpeg;
+    if (setjmp(err.salto)) { jpeg_destroy_compress(&info); return false; }
+    jpeg_create_compress(&info);
+    jpeg_mem_dest(&info, &salida.datos, &salida.tamano);
+    info.image_width = ancho; info.image_height = alto; info.input_components = 3; info.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&info); jpeg_set_quality(&info, calidad, TRUE);
+    jpeg_start_compress(&info, TRUE);
+    while (info.next_scanline < alto) {
+        const uint8_t* src = rgba + static_cast<size_t>(info.next_scanline) * ancho * 4;
+        for (uint32_t x = 0; x < ancho; ++x) { fila[x * 3] = src[x * 4]; fila[x * 3 + 1] = src[x * 4 + 1]; fila[x * 3 + 2] = src[x * 4 + 2]; }
+        JSAMPROW p = fila.data(); jpeg_write_scanlines(&info, &p, 1);
+    }
+    jpeg_finish_compress(&info); jpeg_destroy_compress(&info);
+    return true;
+}
+
+} // namespace
+
+Ajuste ajuste_desde_texto(std::string_view aspecto) {
+    if (aspecto == "cover") return Ajuste::Cubrir;
+    if (aspecto == "fill") return Ajuste::Estirar;
+    return Ajuste::Contener;
+}
+
+void tamano_ajustado(uint32_t ancho, uint32_t alto, uint32_t max_ancho, uint32_t max_alto, Ajuste ajuste, uint32_t& out_ancho, uint32_t& out_alto) {
+    out_ancho = out_alto = 0;
+    if (!ancho || !alto || !max_ancho || !max_alto) return;
+    if (ajuste != Ajuste::Contener) { out_ancho = max_ancho; out_alto = max_alto; return; }
+    double escala = std::min(static_cast<double>(max_ancho) / ancho, static_cast<double>(max_alto) / alto);
+    out_ancho = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(ancho * escala)), 1, max_ancho);
+    out_alto = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(alto * escala)), 1, max_alto);
+}
+
+Resultado decodificar(const std::vector<uint8_t>& archivo, uint32_t max_ancho, uint32_t max_alto, Ajuste ajuste, const Reservar& reservar) {
+    Resultado r; Fuente f;
+    bool jpeg = archivo.size() > 3 && archivo[0] == 0xFF && archivo[1] == 0xD8 && archivo[2] == 0xFF;
+    bool png = archivo.size() > 8 && png_sig_cmp(archivo.data(), 0, 8) == 0;
+    if (!jpeg && !png) { r.error = "formato no reconocido (se aceptan JPEG y PNG)"; return r; }
+    if (jpeg ? !leer_jpeg(archivo, max_ancho, max_alto, ajuste, f, r.error) : !leer_png(archivo, f, r.error)) return r;
+    Plan plan = planificar(f.ancho, f.alto, max_ancho, max_alto, ajuste);
+    if (!plan.destino_ancho || !plan.destino_alto) { r.error = "tamaño vacío"; return r; }
+    uint8_t* destino = reservar(plan.destino_ancho, plan.destino_alto);
+    if (!destino) { r.error = "cancelada"; return r; }
+    escalar(f, plan, destino);
+    r.ok = true; r.ancho = plan.destino_ancho; r.alto = plan.destino_alto;
+    return r;
+}
+
+Resultado decodificar_archivo(const std::string& ruta, uint32_t max_ancho, uint32_t max_alto, Ajuste ajuste, const Reservar& reservar) {
+    std::ifstream f(ruta, std::ios::binary | std::ios::ate);
+    if (!f) { Resultado r; r.error = "no se pudo abrir " + ruta; return r; }
+    std::vector<uint8_t> archivo(static_cast<size_t>(f.tellg())); f.seekg(0);
+    f.read(reinterpret_cast<char*>(archivo.data()), static_cast<std::streamsize>(archivo.size()));
+    return decodificar(archivo, max_ancho, max_alto, ajuste, reservar);
+}
+
+std::vector<uint8_t> codificar_jpeg(const uint8_t* rgba, uint32_t ancho, uint32_t alto, int calidad) {
+    std::vector<uint8_t> fila(static_cast<size_t>(ancho) * 3), jpeg; SalidaJpeg salida;
+    if (ancho && alto && comprimir_jpeg(rgba, ancho, alto, calidad, fila, salida)) jpeg.assign(salida.datos, salida.datos + salida.tamano);
+    std::free(salida.datos);
+    return jpeg;
+}
+
+bool es_imagen(const std::string& ruta) {
+    std::string ext = std::filesystem::path(ruta).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".jpg" || ext == ".jpeg" || ext == ".png";
+}
+
+} // namespace imagenes
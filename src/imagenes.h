@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Decodificación y escalado de imágenes (JPEG con libjpeg, PNG con libpng) para los fondos del proyector
+// y las miniaturas. Pensado para hilos de trabajo: no toca la interfaz ni guarda estado.
+namespace imagenes {
+
+// Cómo ocupa la imagen el área de destino; en multimedia.db es la columna `aspecto`
+enum class Ajuste {
+    Contener, // "contain": entra completa y conserva la proporción (puede quedar más chica que el área)
+    Cubrir,   // "cover": llena el área y se recorta al centro lo que sobra
+    Estirar   // "fill": llena el área deformándose
+};
+Ajuste ajuste_desde_texto(std::string_view aspecto);
+
+// El destino lo reserva quien llama: RGBA8, filas contiguas de ancho * 4 bytes. Así la app escribe
+// directo en el buffer que después muestra Slint, sin copias. Devolver nullptr cancela.
+using Reservar = std::function<uint8_t*(uint32_t ancho, uint32_t alto)>;
+
+struct Resultado { bool ok = false; uint32_t ancho = 0; uint32_t alto = 0; std::string error; };
+
+// Tamaño final de una imagen de ancho x alto ajustada a un área de max_ancho x max_alto
+void tamano_ajustado(uint32_t ancho, uint32_t alto, uint32_t max_ancho, uint32_t max_alto, Ajuste ajuste, uint32_t& out_ancho, uint32_t& out_alto);
+
+// Decodifica un JPEG o un PNG (se reconoce por el contenido) ya escalado al área: promedia al reducir e
+// interpola al ampliar. Si el área es bastante más chica, los JPEG se reducen (1/2, 1/4, 1/8...) mientras
+// se decodifican, que es mucho más barato que decodificar completo y después escalar.
+Resultado decodificar(const std::vector<uint8_t>& archivo, uint32_t max_ancho, uint32_t max_alto, Ajuste ajuste, const Reservar& reservar);
+Resultado decodificar_archivo(const std::string& ruta, uint32_t max_ancho, uint32_t max_alto, Ajuste ajuste, const Reservar& reservar);
+
+// JPEG (sin alfa) de una imagen RGBA8, para guardar miniaturas. Vacío si falla.
+std::vector<uint8_t> codificar_jpeg(const uint8_t* rgba, uint32_t ancho, uint32_t alto, int calidad = 82);
+
+// Por la extensión, al recorrer una carpeta
+bool es_imagen(const std::string& ruta);
+
+} // namespace imagenes
@@ -0,0 +1,194 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstdint>
+
+// Lectura de himnarios para la importación masiva.
+// Formatos aceptados:
+//  - .txt de un solo canto: el título es el nombre del archivo y todo el contenido es la letra.
+//  - .txt con varios cantos: cada canto empieza con una línea "# Título".
+//  - .json: [{"titulo": "...", "letra": "..."}] o {"cantos": [...]}; "letra" puede ser
+//    un texto o una lista de estrofas. También se aceptan "title" y "lyrics".
+// Una carpeta se recorre (sin subcarpetas) en orden alfabético leyendo los .txt y .json.
+
+struct CantoImportado { std::string titulo; std::string letra; };
+
+namespace importador {
+
+namespace fs = std::filesystem;
+
+inline std::string leer_archivo(const fs::path& ruta) {
+    std::ifstream in(ruta, std::ios::binary); std::ostringstream ss; ss << in.rdbuf();
+    std::string contenido = ss.str();
+    if (contenido.rfind("\xEF\xBB\xBF", 0) == 0) contenido.erase(0, 3); // BOM UTF-8
+    contenido.erase(std::remove(contenido.begin(), contenido.end(), '\r'), contenido.end());
+    return contenido;
+}
+
+inline std::string recortar(std::string_view s) {
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) return "";
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return std::string(s.substr(first, last - first + 1));
+}
+
+inline void leer_texto(const std::string& contenido, const std::string& titulo_archivo, std::vector<CantoImportado>& salida) {
+    bool varios = contenido.rfind("# ", 0) == 0 || contenido.find("\n# ") != std::string::npos;
+    if (!varios) {
+        std::string letra = recortar(contenido);
+        if (!letra.empty()) salida.push_back({ titulo_archivo, std::move(letra) });
+        return;
+    }
+    CantoImportado actual; bool abierto = false;
+    auto cerrar = [&]() { if (abierto && !actual.titulo.empty()) { actual.letra = recortar(actual.letra); salida.push_back(std::move(actual)); } actual = {}; };
+    size_t pos = 0;
+    while (pos <= contenido.size()) {
+        size_t fin = contenido.find('\n', pos); if (fin == std::string::npos) fin = contenido.size();
+        std::string_view linea(contenido.data() + pos, fin - pos);
+        if (linea.rfind("# ", 0) == 0) { cerrar(); actual.titulo = recortar(linea.substr(2)); abierto = true; }
+        else if (abierto) { actual.letra.append(linea); actual.letra.push_back('\n'); }
+        pos = fin + 1;
+    }
+    cerrar();
+}
+
+// --- JSON mínimo (solo lo necesario para listas de cantos) ---
+class LectorJson {
+private:
+    std::string_view s; size_t i = 0;
+
+    void espacios() { while (i < s.size() && (s[i] == ' ' || s[i] == '\n' || s[i] == '\t' || s[i] == '\r')) i++; }
+    bool consumir(char c) { espacios(); if (i < s.size() && s[i] == c) { i++; return true; } return false; }
+
+    static void agregar_utf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) out.push_back(static_cast<char>(cp));
+        else if (cp < 0x800) { out.push_back(static_cast<char>(0xC0 | (cp >> 6))); out.push_back(static_cast<char>(0x80 | (cp & 0x3F))); }
+        else if (cp < 0x10000) { out.push_back(static_cast<char>(0xE0 | (cp >> 12))); out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F))); out.push_back(static_cast<char>(0x80 | (cp & 0x3F))); }
+        else { out.push_back(static_cast<char>(0xF0 | (cp >> 18))); out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F))); out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F))); out.push_back(static_cast<char>(0x80 | (cp & 0x3F))); }
+    }
+    bool hex4(uint32_t& cp) {
+        if (i + 4 > s.size()) return false;
+        cp = 0;
+        for (int k = 0; k < 4; ++k) {
+            char c = s[i++]; cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= c - '0'; else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10; else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10; else return false;
+        } return true;
+    }
+
+public:
+    bool ok = true;
+    explicit LectorJson(std::string_view texto) : s(texto) {}
+
+    bool cadena(std::string& out) {
+        if (!consumir('"')) return ok = false;
+        while (i < s.size() && s[i] != '"') {
+            char c = s[i++];
+            if (c != '\\') { out.push_back(c); continue; }
+            if (i >= s.size()) return ok = false;
+            switch (char e = s[i++]) {
+                case 'n': out.push_back('\n'); break; case 't': out.push_back('\t'); break; case 'r': break;
+                case 'b': out.push_back('\b'); break; case 'f': out.push_back('\f'); break;
+                case 'u': {
+                    uint32_t cp; if (!hex4(cp)) return ok = false;
+                    // Un par sustituto (\uD83D\uDE00) se junta en un solo carácter; una mitad suelta no es
+                    // un carácter válido y queda como U+FFFD. Lo que sigue a una mitad suelta se lee aparte.
+                    if (cp >= 0xD800 && cp < 0xDC00) {
+                        size_t despues = i; uint32_t lo = 0;
+                        if (i + 1 < s.size() && s[i] == '\\' && s[i + 1] == 'u' && (i += 2, hex4(lo)) && lo >= 0xDC00 && lo < 0xE000) cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        else { i = despues; cp = 0xFFFD; }
+                    } else if (cp >= 0xDC00 && cp < 0xE000) cp = 0xFFFD;
+                    agregar_utf8(out, cp); break;
+                }
+                default: out.push_back(e);
+            }
+        }
+        return consumir('"') || (ok = false);
+    }
+
+    void saltar_valor() {
+        espacios(); if (i >= s.size()) { ok = false; return; }
+        if (s[i] == '"') { std::string tmp; cadena(tmp); return; }
+        if (s[i] == '{' || s[i] == '[') {
+            char cierre = s[i] == '{' ? '}' : ']'; i++;
+            if (consumir(cierre)) return;
+            do { if (cierre == '}') { std::string k; cadena(k); if (!consumir(':')) { ok = false; return; } } saltar_valor(); } while (ok && consumir(','));
+            if (!consumir(cierre)) ok = false;
+            return;
+        }
+        while (i < s.size() && s[i] != ',' && s[i] != '}' && s[i] != ']' && s[i] != ' ' && s[i] != '\n') i++;
+    }
+
+    // Lee un canto {"titulo": ..., "letra": ...}
+    bool canto(CantoImportado& c) {
+        if (!consumir('{')) return ok = false;
+        if (consumir('}')) return true;
+        do {
+            std::string clave; if (!cadena(clave) || !consumir(':')) return ok = false;
+            if (clave == "titulo" || clave == "title") cadena(c.titulo);
+            else if (clave == "letra" || clave == "lyrics") {
+                espacios();
+                if (i < s.size() && s[i] == '[') {
+                    i++;
+                    if (!consumir(']')) {
+                        do { std::string estrofa; cadena(estrofa); if (!c.letra.empty()) c.letra += "\n\n"; c.letra += estrofa; } while (ok && consumir(','));
+                        if (!consumir(']')) return ok = false;
+                    }
+                } else cadena(c.letra);
+            } else saltar_valor();
+        } while (ok && consumir(','));
+        return consumir('}') || (ok = false);
+    }
+
+    void lista(std::vector<CantoImportado>& salida) {
+        if (consumir('{')) {
+            // Objeto contenedor: buscamos la clave "cantos"/"songs"
+            if (consumir('}')) return;
+            do {
+                std::string clave; if (!cadena(clave) || !consumir(':')) { ok = false; return; }
+                if (clave == "cantos" || clave == "songs") lista(salida); else saltar_valor();
+            } while (ok && consumir(','));
+            if (!consumir('}')) ok = false;
+            return;
+        }
+        if (!consumir('[')) { ok = false; return; }
+        if (consumir(']')) return;
+        do { CantoImportado c; if (canto(c) && !c.titulo.empty()) salida.push_back(std::move(c)); } while (ok && consumir(','));
+        if (!consumir(']')) ok = false;
+    }
+};
+
+inline bool leer_archivo_cantos(const fs::path& ruta, std::vector<CantoImportado>& salida) {
+    std::string ext = ruta.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == ".json") {
+        std::string contenido = leer_archivo(ruta);
+        LectorJson lector(contenido); lector.lista(salida); return lector.ok;
+    }
+    if (ext == ".txt") { leer_texto(leer_archivo(ruta), ruta.stem().string(), salida); return true; }
+    return false;
+}
+
+// Lee una carpeta o un archivo. Devuelve false si la ruta no existe o algún archivo está mal formado
+// (los cantos válidos leídos hasta ese punto se conservan en la salida).
+inline bool leer_cantos(const fs::path& ruta, std::vector<CantoImportado>& salida) {
+    std::error_code ec;
+    if (fs::is_regular_file(ruta, ec)) return leer_archivo_cantos(ruta, salida);
+    if (!fs::is_directory(ruta, ec)) return false;
+    std::vector<fs::path> archivos;
+    for (const auto& entrada : fs::directory_iterator(ruta, ec)) if (entrada.is_regular_file()) archivos.push_back(entrada.path());
+    std::sort(archivos.begin(), archivos.end());
+    bool ok = true;
+    for (const auto& archivo : archivos) {
+        std::string ext = archivo.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == ".txt" || ext == ".json") ok = leer_archivo_cantos(archivo, salida) && ok;
+    }
+    return ok;
+}
+
+} // namespace importador
@@ -0,0 +1,101 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+const std::vector<std::string> NOMBRES_LIBROS = {
+    "Génesis", "Éxodo", "Levítico", "Números", "Deuteronomio", "Josué", "Jueces", "Rut", "1 Samuel", "2 Samuel",
+    "1 Reyes", "2 Reyes", "1 Crónicas", "2 Crónicas", "Esdras", "Nehemías", "Ester", "Job", "Salmos", "Proverbios",
+    "Eclesiastés", "Cantares", "Isaías", "Jeremías", "Lamentaciones", "Ezequiel", "Daniel", "Oseas", "Joel", "Amós",
+    "Abdías", "Jonás", "Miqueas", "Nahúm", "Habacuc", "Sofonías", "Hageo", "Zacarías", "Malaquías", "Mateo",
+    "Marcos", "Lucas", "Juan", "Hechos", "Romanos", "1 Corintios", "2 Corintios", "Gálatas", "Efesios", "Filipenses",
+    "Colosenses", "1 Tesalonicenses", "2 Tesalonicenses", "1 Timoteo", "2 Timoteo", "Tito", "Filemón", "Hebreos", "Santiago",
+    "1 Pedro", "2 Pedro", "1 Juan", "2 Juan", "3 Juan", "Judas", "Apocalipsis"
+};
+
+// Abreviaturas usuales (número de libro 1-66). Solo se usan si no chocan con el prefijo de un nombre:
+// "he" sigue siendo Hechos mientras se escribe, "heb" ya es Hebreos.
+const std::vector<std::pair<std::string, int>> ABREVIATURAS_LIBROS = {
+    {"gn", 1}, {"gen", 1}, {"ex", 2}, {"lv", 3}, {"nm", 4}, {"dt", 5}, {"jos", 6}, {"jc", 7}, {"rt", 8},
+    {"1s", 9}, {"1sa", 9}, {"2s", 10}, {"2sa", 10}, {"1r", 11}, {"1re", 11}, {"2r", 12}, {"2re", 12}, {"1cr", 13}, {"2cr", 14},
+    {"esd", 15}, {"ne", 16}, {"est", 17}, {"jb", 18}, {"sal", 19}, {"sl", 19}, {"pr", 20}, {"prov", 20}, {"ec", 21}, {"ecl", 21},
+    {"cnt", 22}, {"ct", 22}, {"cant", 22}, {"is", 23}, {"jr", 24}, {"jer", 24}, {"lm", 25}, {"lam", 25}, {"ez", 26}, {"dn", 27},
+    {"os", 28}, {"jl", 29}, {"am", 30}, {"abd", 31}, {"jon", 32}, {"mi", 33}, {"miq", 33}, {"nah", 34}, {"hab", 35}, {"sof", 36},
+    {"hag", 37}, {"zac", 38}, {"mal", 39}, {"mt", 40}, {"mr", 41}, {"mc", 41}, {"lc", 42}, {"jn", 43}, {"hch", 44}, {"ro", 45},
+    {"rom", 45}, {"1co", 46}, {"2co", 47}, {"ga", 48}, {"gal", 48}, {"ef", 49}, {"flp", 50}, {"fil", 50}, {"col", 51},
+    {"1ts", 52}, {"1tes", 52}, {"2ts", 53}, {"2tes", 53}, {"1ti", 54}, {"1tim", 54}, {"2ti", 55}, {"2tim", 55}, {"tit", 56},
+    {"flm", 57}, {"heb", 58}, {"stg", 59}, {"sant", 59}, {"1p", 60}, {"1pe", 60}, {"2p", 61}, {"2pe", 61},
+    {"1jn", 62}, {"2jn", 63}, {"3jn", 64}, {"jud", 65}, {"ap", 66}, {"apoc", 66}
+};
+
+// Clave de comparación de un nombre de libro: minúsculas, sin acentos (UTF-8 precompuesto o con
+// diacríticos combinados) y sin espacios, puntos ni guiones. "1 Co." y "1co" dan lo mismo,
+// igual que "Génesis", "GENESIS" y "genesis". Los caracteres fuera de Latin-1 pasan sin cambios.
+inline void normalizar_clave_libro(std::string_view texto, std::string& salida) {
+    // Letra base de U+00C0..U+00FF (segundo byte 0x80..0xBF tras 0xC3); 0 = se copia tal cual
+    static constexpr char BASE_LATIN1[64] = {
+        'a','a','a','a','a','a', 0 ,'c','e','e','e','e','i','i','i','i',
+         0 ,'n','o','o','o','o','o', 0 , 0 ,'u','u','u','u','y', 0 , 0 ,
+        'a','a','a','a','a','a', 0 ,'c','e','e','e','e','i','i','i','i',
+         0 ,'n','o','o','o','o','o', 0 , 0 ,'u','u','u','u','y', 0 ,'y'
+    };
+    salida.clear();
+    for (size_t i = 0; i < texto.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(texto[i]);
+        if (c < 0x80) {
+            if (c == ' ' || c == '.' || c == '-' || c == '\t') continue;
+            salida.push_back(c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : static_cast<char>(c));
+            continue;
+        }
+        if (i + 1 < texto.size()) {
+            unsigned char c2 = static_cast<unsigned char>(texto[i + 1]);
+            if (c == 0xC3 && c2 >= 0x80 && c2 <= 0xBF && BASE_LATIN1[c2 - 0x80]) { salida.push_back(BASE_LATIN1[c2 - 0x80]); ++i; continue; }
+            // Diacríticos combinados U+0300..U+036F: se descartan
+            if ((c == 0xCC && c2 >= 0x80) || (c == 0xCD && c2 <= 0xAF)) { ++i; continue; }
+        }
+        salida.push_back(static_cast<char>(c));
+    }
+}
+
+// Índice de libros para la búsqueda rápida de la Biblia. Se construye una vez con todos los
+// prefijos normalizados de cada nombre (el primer libro en orden canónico gana, como antes con
+// el recorrido lineal) más las abreviaturas, así cada tecla es una sola búsqueda en el hash.
+class IndiceLibros {
+private:
+    std::vector<std::string> nombres;
+    std::unordered_map<std::string, int> por_clave; // clave normalizada -> número de libro
+    size_t largo_maximo = 0;
+
+public:
+    explicit IndiceLibros(const std::vector<std::string>& nombres_libros = NOMBRES_LIBROS,
+                          const std::vector<std::pair<std::string, int>>& abreviaturas = ABREVIATURAS_LIBROS) : nombres(nombres_libros) {
+        std::string clave;
+        for (size_t i = 0; i < nombres.size(); ++i) {
+            normalizar_clave_libro(nombres[i], clave);
+            largo_maximo = std::max(largo_maximo, clave.size());
+            for (size_t n = 1; n <= clave.size(); ++n) por_clave.emplace(clave.substr(0, n), static_cast<int>(i + 1));
+        }
+        for (const auto& [abrev, libro] : abreviaturas) {
+            if (libro < 1 || static_cast<size_t>(libro) > nombres.size()) continue;
+            normalizar_clave_libro(abrev, clave);
+            largo_maximo = std::max(largo_maximo, clave.size());
+            por_clave.emplace(clave, libro);
+        }
+    }
+
+    // Devuelve el nombre del libro y deja su número en out_id; vacío si nada coincide
+    std::string_view buscar(std::string_view consulta, int& out_id) const {
+        thread_local std::string clave;
+        normalizar_clave_libro(consulta, clave);
+        if (clave.empty() || clave.size() > largo_maximo) return {};
+        auto it = por_clave.find(clave);
+        if (it == por_clave.end()) return {};
+        out_id = it->second; return nombres[it->second - 1];
+    }
+
+    const std::string& nombre(int libro) const { return nombres.at(libro - 1); }
+    size_t size() const { return nombres.size(); }
+};
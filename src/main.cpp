@@ -1,369 +1,436 @@
 #include "main_ui.h" 
-#include <sqlite3.h>
+#include "app_state.h"
+#include "arranque.h"
+#include "busqueda_diferida.h"
+#include "pool_trabajo.h"
+#include "indice_libros.h"
+#include "referencia_biblica.h"
+#include "ajuste_texto.h"
+#include "traza.h"
+#include "galeria_imagenes.h"
 #include <vector>
 #include <string>
 #include <iostream>
 #include <memory>
-#include <filesystem>
-#include <mutex>
-#include <regex>
 #include <algorithm>
-#include <cctype>
 #include <unordered_map>
+#include <unordered_set>
 #include <thread>
+#include <atomic>
 #include <functional>
-
-namespace fs = std::filesystem;
-
-struct CantoDB { int id; std::string titulo; std::string tono; std::string categoria; };
-struct Diapositiva { int id; int orden; std::string texto; };
-struct LibroBiblia { int id; std::string nombre; int capitulos; };
-struct Versiculo { int capitulo; int versiculo; std::string texto; };
-
-struct CacheKey {
-    int version_id; int libro_numero; int capitulo;
-    bool operator==(const CacheKey& other) const { return version_id == other.version_id && libro_numero == other.libro_numero && capitulo == other.capitulo; }
-};
-struct CacheKeyHash { std::size_t operator()(const CacheKey& k) const { return std::hash<int>()(k.version_id) ^ (std::hash<int>()(k.libro_numero) << 1) ^ (std::hash<int>()(k.capitulo) << 2); } };
-
-struct VersionInfo { int id; std::string sigla; std::string nombre_completo; int prioridad; };
-
-const std::vector<std::string> NOMBRES_LIBROS = {
-    "Génesis", "Éxodo", "Levítico", "Números", "Deuteronomio", "Josué", "Jueces", "Rut", "1 Samuel", "2 Samuel",
-    "1 Reyes", "2 Reyes", "1 Crónicas", "2 Crónicas", "Esdras", "Nehemías", "Ester", "Job", "Salmos", "Proverbios",
-    "Eclesiastés", "Cantares", "Isaías", "Jeremías", "Lamentaciones", "Ezequiel", "Daniel", "Oseas", "Joel", "Amós",
-    "Abdías", "Jonás", "Miqueas", "Nahúm", "Habacuc", "Sofonías", "Hageo", "Zacarías", "Malaquías", "Mateo",
-    "Marcos", "Lucas", "Juan", "Hechos", "Romanos", "1 Corintios", "2 Corintios", "Gálatas", "Efesios", "Filipenses",
-    "Colosenses", "1 Tesalonicenses", "2 Tesalonicenses", "1 Timoteo", "2 Timoteo", "Tito", "Filemón", "Hebreos", "Santiago",
-    "1 Pedro", "2 Pedro", "1 Juan", "2 Juan", "3 Juan", "Judas", "Apocalipsis"
-};
-
-std::string trim(const std::string& str) {
-    size_t first = str.find_first_not_of(" \t\r\n");
-    if (std::string::npos == first) return "";
-    size_t last = str.find_last_not_of(" \t\r\n");
-    return str.substr(first, (last - first + 1));
+#include <string_view>
+#include <cstdint>
+#include <chrono>
+#include <cstdlib>
+
+// Fuente del texto proyectado (Inter, la misma que registra main_ui.slint). EASYPRESENTER_FUENTE la reemplaza.
+std::string ruta_fuente_proyector() {
+    if (const char* env = std::getenv("EASYPRESENTER_FUENTE")) return env;
+#ifdef EASYPRESENTER_FUENTE_PROYECTOR
+    return EASYPRESENTER_FUENTE_PROYECTOR;
+#else
+    return "ui/fonts/Inter-VariableFont_opsz,wght.ttf";
+#endif
 }
 
-std::string to_lower(const std::string& str) {
-    std::string lower_str = str;
-    std::transform(lower_str.begin(), lower_str.end(), lower_str.begin(), ::tolower);
-    return lower_str;
+// Área del Text principal de projector_ui.slint en px lógicos: la ventana menos el padding (40 por lado),
+// el margen del Text (40 por lado), la franja fija de 60 px y, si hay referencia, su fila (45 + 20 de spacing).
+// Antes de mostrarse la ventana no tiene tamaño: se asume el proyector de 1920x1080.
+AjusteTexto::Area area_texto_proyector(const slint::ComponentHandle<ProjectorWindow>& proyector, bool con_referencia) {
+    auto fisico = proyector->window().size(); float escala = proyector->window().scale_factor();
+    float ancho = fisico.width ? fisico.width / (escala > 0 ? escala : 1.0f) : 1920.0f, alto = fisico.height ? fisico.height / (escala > 0 ? escala : 1.0f) : 1080.0f;
+    return { static_cast<int>(ancho) - 160, static_cast<int>(alto) - 140 - (con_referencia ? 65 : 0) };
 }
 
-std::string buscar_libro_inteligente(const std::string& query, int& out_id) {
-    std::string q = to_lower(trim(query));
-    if (q.empty()) return "";
-    for (size_t i = 0; i < NOMBRES_LIBROS.size(); ++i) {
-        if (to_lower(NOMBRES_LIBROS[i]).find(q) == 0) { out_id = i + 1; return NOMBRES_LIBROS[i]; }
-    }
-    return "";
+// Los fondos se escalan al tamaño físico de la ventana del proyector (1920x1080 mientras no se muestra)
+ClaveFondo tamano_fondo_proyector(const slint::ComponentHandle<ProjectorWindow>& proyector, int imagen_id) {
+    auto fisico = proyector->window().size();
+    return { imagen_id, fisico.width ? fisico.width : 1920, fisico.height ? fisico.height : 1080 };
 }
 
-class AppState {
-private:
-    sqlite3* cantos_db = nullptr;
-    sqlite3* biblias_db = nullptr;
-    std::mutex db_mutex;
-    std::vector<VersionInfo> versiones_cargadas;
-    int current_version_id = 1;
-    std::unordered_map<CacheKey, std::vector<Versiculo>, CacheKeyHash> chapter_cache;
-    std::mutex cache_mutex;
-
-    sqlite3* setup_db(const std::string& db_name) {
-        std::string base_path = "/home/basanteriano/Documentos/EasyPresenter/EasyPresenter_c++/data/";
-        if (!fs::exists(base_path)) fs::create_directories(base_path);
-        sqlite3* db;
-        if (sqlite3_open((base_path + db_name).c_str(), &db) != SQLITE_OK) return nullptr;
-        sqlite3_exec(db, "PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;", nullptr, nullptr, nullptr);
-        return db;
-    }
-
-    void insert_diapositivas_intern(int canto_id, const std::string& letra) {
-        size_t start = 0, end = 0; int orden = 1;
-        while ((end = letra.find("\n\n", start)) != std::string::npos) {
-            std::string estrofa = trim(letra.substr(start, end - start));
-            if (!estrofa.empty()) {
-                sqlite3_stmt* stmt;
-                if (sqlite3_prepare_v2(cantos_db, "INSERT INTO diapositivas (canto_id, orden, texto) VALUES (?, ?, ?)", -1, &stmt, nullptr) == SQLITE_OK) {
-                    sqlite3_bind_int(stmt, 1, canto_id); sqlite3_bind_int(stmt, 2, orden++); sqlite3_bind_text(stmt, 3, estrofa.c_str(), -1, SQLITE_TRANSIENT); sqlite3_step(stmt);
-                } sqlite3_finalize(stmt);
-            } start = end + 2;
-        }
-        std::string estrofa = trim(letra.substr(start));
-        if (!estrofa.empty()) {
-            sqlite3_stmt* stmt;
-            if (sqlite3_prepare_v2(cantos_db, "INSERT INTO diapositivas (canto_id, orden, texto) VALUES (?, ?, ?)", -1, &stmt, nullptr) == SQLITE_OK) {
-                sqlite3_bind_int(stmt, 1, canto_id); sqlite3_bind_int(stmt, 2, orden); sqlite3_bind_text(stmt, 3, estrofa.c_str(), -1, SQLITE_TRANSIENT); sqlite3_step(stmt);
-            } sqlite3_finalize(stmt);
-        }
-    }
-
-    void procesar_versiones() {
-        sqlite3_stmt* stmt;
-        if (sqlite3_prepare_v2(biblias_db, "SELECT id, nombre FROM versiones", -1, &stmt, nullptr) == SQLITE_OK) {
-            while (sqlite3_step(stmt) == SQLITE_ROW) {
-                int id = sqlite3_column_int(stmt, 0); 
-                std::string nombre_bd = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-                
-                std::string sigla = "OTRA"; 
-                std::string nombre_comp = nombre_bd;
-                int prioridad = 999; 
-
-                // --- BÚSQUEDA EXACTA ---
-                // Comparamos exactamente con los nombres de tu base de datos
-                
-                if (nombre_bd == "ReinaValera1960") { 
-                    sigla = "RVR"; nombre_comp = "Reina Valera 1960"; prioridad = 0; 
-                }
-                else if (nombre_bd == "NuevaVersiónInternacional") { 
-                    sigla = "NVI"; nombre_comp = "Nueva Versión Internacional"; prioridad = 1; 
-                }
-                else if (nombre_bd == "NuevaTraduccionViviente") { 
-                    sigla = "NTV"; nombre_comp = "Nueva Traducción Viviente"; prioridad = 2; 
-                }
-                else if (nombre_bd == "BibliaDeLasAméricas") { 
-                    sigla = "LBLA"; nombre_comp = "La Biblia de las Américas"; prioridad = 3; 
-                }
-                else if (nombre_bd == "NuevaBibliadelasAméricas") { 
-                    sigla = "NBLA"; nombre_comp = "Nueva Biblia de las Américas"; prioridad = 4; 
-                }
-                else if (nombre_bd == "TraduccionLenguajeActual") { 
-                    sigla = "TLA"; nombre_comp = "Traducción en Lenguaje Actual"; prioridad = 5; 
-                }
-                else if (nombre_bd == "DiosHablaHoy") { 
-                    sigla = "DHH"; nombre_comp = "Dios Habla Hoy"; prioridad = 6; 
-                }
-                else if (nombre_bd == "LaPalabra") { 
-                    sigla = "BLP"; nombre_comp = "La Palabra"; prioridad = 7; 
-                }
-                else if (nombre_bd == "TraduccionInterconfesionalVersionHispanoamericana") { 
-                    sigla = "TIVH"; nombre_comp = "Trad. Interconfesional Hispanoamericana"; prioridad = 8; 
-                }
-                else if (nombre_bd == "BibliaTextual") { 
-                    sigla = "BTX"; nombre_comp = "Biblia Textual"; prioridad = 9; 
-                }
-                else if (nombre_bd == "BibliaJubileo") { 
-                    sigla = "JUB"; nombre_comp = "Biblia del Jubileo"; prioridad = 10; 
-                }
-                else if (nombre_bd == "BibliadelOso1573") { 
-                    sigla = "OSO"; nombre_comp = "Biblia del Oso 1573"; prioridad = 11; 
-                }
-                else {
-                    // Por si en el futuro agregas una biblia que no está en esta lista
-                    sigla = nombre_bd.length() >= 4 ? nombre_bd.substr(0, 4) : nombre_bd;
-                    std::transform(sigla.begin(), sigla.end(), sigla.begin(), ::toupper);
-                }
-
-                versiones_cargadas.push_back({id, sigla, nombre_comp, prioridad});
-            }
-        } sqlite3_finalize(stmt);
-        
-        // Ordenamos por la prioridad que asignaste arriba (0, 1, 2, 3...)
-        std::sort(versiones_cargadas.begin(), versiones_cargadas.end(), [](const VersionInfo& a, const VersionInfo& b) { 
-            return a.prioridad < b.prioridad; 
-        });
+// Modelo de diapositivas del panel respaldado por lo que ya está en memoria: el capítulo que comparte el
+// cache o las diapositivas de un canto. Cargar no copia nada; cada fila se arma cuando Slint la pide,
+// así el ListView solo convierte las que están a la vista. Cambiar de contenido actualiza las filas en
+// su lugar (notify_row_changed) y solo agrega o quita las sobrantes, sin crear un modelo nuevo.
+class ModeloDiapositivas : public slint::Model<DiapositivaUI> {
+public:
+    using Diapositivas = std::shared_ptr<const std::vector<Diapositiva>>;
 
-        if (!versiones_cargadas.empty()) current_version_id = versiones_cargadas[0].id;
+private:
+    CapituloPtr capitulo;       // versículos: orden = número de versículo
+    Diapositivas diapositivas;  // canto o elemento de la lista de servicio
+
+    void avisar_cambio(size_t antes) {
+        size_t ahora = row_count();
+        for (size_t i = 0, comunes = std::min(antes, ahora); i < comunes; ++i) notify_row_changed(i);
+        if (ahora > antes) notify_row_added(antes, ahora - antes);
+        else if (antes > ahora) notify_row_removed(ahora, antes - ahora);
     }
 
 public:
-    AppState() { cantos_db = setup_db("cantos.db"); biblias_db = setup_db("biblias.db"); if(biblias_db) procesar_versiones(); }
-    ~AppState() { if (cantos_db) sqlite3_close(cantos_db); if (biblias_db) sqlite3_close(biblias_db); }
-
-    std::vector<CantoDB> get_all_cantos() {
-        std::lock_guard<std::mutex> lock(db_mutex); std::vector<CantoDB> lista; sqlite3_stmt* stmt;
-        if (sqlite3_prepare_v2(cantos_db, "SELECT id, titulo FROM cantos ORDER BY titulo", -1, &stmt, nullptr) == SQLITE_OK) {
-            while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ sqlite3_column_int(stmt, 0), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), "", "" });
-        } sqlite3_finalize(stmt); return lista;
-    }
-    std::vector<CantoDB> get_cantos_filtrados(const std::string& busqueda) {
-        std::lock_guard<std::mutex> lock(db_mutex); std::vector<CantoDB> lista; sqlite3_stmt* stmt;
-        if (sqlite3_prepare_v2(cantos_db, "SELECT id, titulo FROM cantos WHERE titulo LIKE ? ORDER BY titulo", -1, &stmt, nullptr) == SQLITE_OK) {
-            std::string parametro = "%" + busqueda + "%"; sqlite3_bind_text(stmt, 1, parametro.c_str(), -1, SQLITE_TRANSIENT);
-            while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ sqlite3_column_int(stmt, 0), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), "", "" });
-        } sqlite3_finalize(stmt); return lista;
-    }
-    std::string get_canto_titulo(int id) {
-        std::lock_guard<std::mutex> lock(db_mutex); std::string titulo = ""; sqlite3_stmt* stmt;
-        if (sqlite3_prepare_v2(cantos_db, "SELECT titulo FROM cantos WHERE id = ?", -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, id); if (sqlite3_step(stmt) == SQLITE_ROW) titulo = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        } sqlite3_finalize(stmt); return titulo;
-    }
-    std::vector<Diapositiva> get_canto_diapositivas(int canto_id) {
-        std::lock_guard<std::mutex> lock(db_mutex); std::vector<Diapositiva> lista; sqlite3_stmt* stmt;
-        if (sqlite3_prepare_v2(cantos_db, "SELECT id, orden, texto FROM diapositivas WHERE canto_id = ? ORDER BY orden", -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, canto_id);
-            while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)) });
-        } sqlite3_finalize(stmt); return lista;
-    }
-    void add_canto(const std::string& titulo, const std::string& letra) {
-        std::lock_guard<std::mutex> lock(db_mutex); sqlite3_stmt* stmt;
-        if (sqlite3_prepare_v2(cantos_db, "INSERT INTO cantos (titulo, tono, categoria) VALUES (?, '', 'Personalizado')", -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_text(stmt, 1, titulo.c_str(), -1, SQLITE_TRANSIENT); sqlite3_step(stmt);
-        } sqlite3_finalize(stmt); insert_diapositivas_intern(sqlite3_last_insert_rowid(cantos_db), letra);
-    }
-    void update_canto(int id, const std::string& titulo, const std::string& letra) {
-        std::lock_guard<std::mutex> lock(db_mutex); sqlite3_stmt* stmt;
-        if (sqlite3_prepare_v2(cantos_db, "UPDATE cantos SET titulo = ? WHERE id = ?", -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_text(stmt, 1, titulo.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, id); sqlite3_step(stmt);
-        } sqlite3_finalize(stmt);
-        if (sqlite3_prepare_v2(cantos_db, "DELETE FROM diapositivas WHERE canto_id = ?", -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, id); sqlite3_step(stmt);
-        } sqlite3_finalize(stmt); insert_diapositivas_intern(id, letra);
-    }
-    void delete_canto(int id) {
-        std::lock_guard<std::mutex> lock(db_mutex); sqlite3_stmt* stmt;
-        if (sqlite3_prepare_v2(cantos_db, "DELETE FROM diapositivas WHERE canto_id = ?", -1, &stmt, nullptr) == SQLITE_OK) { sqlite3_bind_int(stmt, 1, id); sqlite3_step(stmt); } sqlite3_finalize(stmt);
-        if (sqlite3_prepare_v2(cantos_db, "DELETE FROM cantos WHERE id = ?", -1, &stmt, nullptr) == SQLITE_OK) { sqlite3_bind_int(stmt, 1, id); sqlite3_step(stmt); } sqlite3_finalize(stmt);
-    }
-
-    std::vector<VersionInfo> get_versiones() { return versiones_cargadas; }
-    int get_current_version_id() { return current_version_id; }
+    ModeloDiapositivas() = default;
+    explicit ModeloDiapositivas(Diapositivas d) : diapositivas(std::move(d)) {}
 
-    // NUEVO: Busca por el Nombre Completo
-    std::string set_version_by_name(const std::string& name) {
-        std::lock_guard<std::mutex> lock(db_mutex);
-        for(const auto& v : versiones_cargadas) {
-            if(v.nombre_completo == name) { current_version_id = v.id; return v.nombre_completo; }
-        } return "";
+    size_t row_count() const override { return capitulo ? capitulo->size() : diapositivas ? diapositivas->size() : 0; }
+    std::optional<DiapositivaUI> row_data(size_t i) const override {
+        if (i >= row_count()) return std::nullopt;
+        return DiapositivaUI{ slint::SharedString(std::to_string(orden(i))), slint::SharedString(texto(i)) };
     }
 
-    std::vector<LibroBiblia> get_libros_biblia() {
-        std::lock_guard<std::mutex> lock(db_mutex); std::vector<LibroBiblia> lista; if (!biblias_db) return lista; sqlite3_stmt* stmt;
-        const char* sql = "SELECT libro_numero, libro_nombre, MAX(capitulo) FROM versiculos WHERE version_id = ? GROUP BY libro_numero ORDER BY libro_numero";
-        if (sqlite3_prepare_v2(biblias_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, current_version_id);
-            while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ sqlite3_column_int(stmt, 0), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), sqlite3_column_int(stmt, 2) });
-        } sqlite3_finalize(stmt); return lista;
-    }
+    void mostrar(CapituloPtr nuevo) { size_t antes = row_count(); capitulo = std::move(nuevo); diapositivas.reset(); avisar_cambio(antes); }
+    void mostrar(Diapositivas nuevas) { size_t antes = row_count(); diapositivas = std::move(nuevas); capitulo.reset(); avisar_cambio(antes); }
 
-    void get_capitulo_async(int libro_numero, int capitulo, std::function<void(std::vector<Versiculo>)> callback) {
-        int v_id = current_version_id; 
-        std::thread([this, v_id, libro_numero, capitulo, callback]() {
-            std::vector<Versiculo> lista;
-            {
-                std::lock_guard<std::mutex> lock(cache_mutex);
-                CacheKey key{v_id, libro_numero, capitulo};
-                if (chapter_cache.find(key) != chapter_cache.end()) {
-                    lista = chapter_cache[key];
-                    slint::invoke_from_event_loop([callback, lista]() { callback(lista); }); return;
-                }
-            }
-            {
-                std::lock_guard<std::mutex> lock(db_mutex); sqlite3_stmt* stmt;
-                const char* sql = "SELECT versiculo, texto FROM versiculos WHERE version_id = ? AND libro_numero = ? AND capitulo = ? ORDER BY versiculo";
-                if (sqlite3_prepare_v2(biblias_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-                    sqlite3_bind_int(stmt, 1, v_id); sqlite3_bind_int(stmt, 2, libro_numero); sqlite3_bind_int(stmt, 3, capitulo);
-                    while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ capitulo, sqlite3_column_int(stmt, 0), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)) });
-                } sqlite3_finalize(stmt);
-            }
-            {
-                std::lock_guard<std::mutex> lock(cache_mutex);
-                CacheKey key{v_id, libro_numero, capitulo}; chapter_cache[key] = lista;
-            }
-            slint::invoke_from_event_loop([callback, lista]() { callback(lista); });
-        }).detach(); 
-    }
+    // Acceso directo a los datos, sin pasar por SharedString
+    int orden(size_t i) const { return capitulo ? (*capitulo)[i].versiculo : (*diapositivas)[i].orden; }
+    const std::string& texto(size_t i) const { return capitulo ? (*capitulo)[i].texto : (*diapositivas)[i].texto; }
+};
+
+// Lista de servicio lista para el culto: por cada elemento, su modelo de Slint y el tamaño de letra de cada
+// diapositiva ya calculado para `area`. Se arma de una vez en el hilo de la UI al terminar la precarga;
+// después, mostrar un elemento es solo asignar punteros.
+struct ElementoEnVivo {
+    slint::SharedString titulo; bool biblico = false;
+    std::shared_ptr<ModeloDiapositivas> diapositivas;
+    std::vector<float> tamanos; AjusteTexto::Area area;
 };
 
+// Modo sin interfaz: EasyPresenter --importar <carpeta|archivo.txt|archivo.json>
+int importar_desde_consola(AppState& app_state, const std::string& ruta) {
+    std::vector<CantoImportado> cantos;
+    auto inicio_lectura = std::chrono::steady_clock::now();
+    bool lectura_ok = importador::leer_cantos(ruta, cantos);
+    double seg_lectura = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio_lectura).count();
+    if (!lectura_ok) std::cerr << "[Importar] Aviso: no se pudo leer completamente " << ruta << std::endl;
+    if (cantos.empty()) { std::cerr << "[Importar] No se encontraron cantos en " << ruta << std::endl; return 1; }
+
+    auto res = app_state.importar_cantos(cantos);
+    double cps = res.segundos > 0 ? res.cantos / res.segundos : 0;
+    std::cout << "[Importar] " << res.cantos << " cantos (" << res.diapositivas << " diapositivas) en " << res.segundos << " s"
+              << " | " << static_cast<long long>(cps) << " cantos/s | lectura: " << seg_lectura << " s";
+    if (res.fallidos) std::cout << " | fallidos: " << res.fallidos;
+    std::cout << std::endl;
+    return res.fallidos ? 1 : 0;
+}
 
-// Helper para obtener la sigla de la versión actual
-std::string get_sigla_version(AppState& app_state) {
-    int current_id = app_state.get_current_version_id();
-    for (const auto& v : app_state.get_versiones()) {
-        if (v.id == current_id) return v.sigla;
+// Aplica una nueva lista de cantos sobre el modelo existente. Si la nueva lista conserva el orden
+// relativo de los cantos que ya se ven (lo normal al seguir escribiendo), solo se quitan e insertan
+// las filas que cambian; si se parecen poco, se reemplaza el contenido de una vez.
+void actualizar_modelo_cantos(slint::VectorModel<Canto>& modelo, std::vector<Canto> nuevos) {
+    traza::Medicion m(traza::Etapa::Modelo, "modelo cantos");
+    std::unordered_set<int> ids_nuevos; for (const auto& c : nuevos) ids_nuevos.insert(c.id);
+    size_t actuales = modelo.row_count(), comunes = 0;
+    std::vector<int> restantes;
+    for (size_t i = 0; i < actuales; ++i) { int id = modelo.row_data(i)->id; if (ids_nuevos.count(id)) { comunes++; restantes.push_back(id); } }
+    // El orden relativo debe mantenerse para poder insertar sin mover filas
+    bool mismo_orden = true;
+    { size_t j = 0; for (const auto& c : nuevos) if (j < restantes.size() && c.id == restantes[j]) j++; mismo_orden = j == restantes.size(); }
+    if (!mismo_orden || comunes * 2 < std::max(actuales, nuevos.size())) { modelo.set_vector(std::move(nuevos)); return; }
+
+    for (size_t i = actuales; i-- > 0;) if (!ids_nuevos.count(modelo.row_data(i)->id)) modelo.erase(i);
+    for (size_t i = 0; i < nuevos.size(); ++i) {
+        auto fila = i < modelo.row_count() ? modelo.row_data(i) : std::nullopt;
+        if (fila && fila->id == nuevos[i].id) { if (!(fila->titulo == nuevos[i].titulo) || !(fila->letra == nuevos[i].letra)) modelo.set_row_data(i, nuevos[i]); }
+        else modelo.insert(i, nuevos[i]);
     }
-    return "";
 }
 
-int main() {
-    AppState app_state;
+int main(int argc, char** argv) {
+    // Con --medir-arranque la app se cierra sola en cuanto termina de cargar (para medir en serie)
+    bool medir_arranque = argc >= 2 && std::string(argv[1]) == "--medir-arranque";
+    MedicionArranque arranque({ "cantos_db", "lista_cantos", "versiones", "libros", "servicio" });
+    auto marcar_arranque = [&arranque, medir_arranque](std::string_view hito) {
+        bool completa = hito == "primer_cuadro" ? arranque.marcar_primer_cuadro() : arranque.marcar(std::string(hito));
+        if (completa && medir_arranque) slint::quit_event_loop();
+    };
+
+    AppState app_state([](std::function<void()> trabajo) { slint::invoke_from_event_loop(std::move(trabajo)); });
+    if (argc >= 3 && std::string(argv[1]) == "--importar") { app_state.abrir(); return importar_desde_consola(app_state, argv[2]); }
+
     auto ui = AppWindow::create();
     auto proyector = ProjectorWindow::create();
+    // Primer cuadro de la ventana principal; si el renderizador no avisa, la primera vuelta del bucle de eventos
+    if (ui->window().set_rendering_notifier([marcar_arranque](slint::RenderingState estado, slint::GraphicsAPI) { if (estado == slint::RenderingState::AfterRendering) marcar_arranque("primer_cuadro"); }))
+        slint::invoke_from_event_loop([marcar_arranque]() { marcar_arranque("primer_cuadro"); });
+
+    // Con EASYPRESENTER_TRAZA, cada cuadro dibujado por el proyector cierra la medición "entrada -> frame"
+    if (traza::activa()) {
+        traza::Registro::global().nombrar_hilo("ui");
+        if (proyector->window().set_rendering_notifier([](slint::RenderingState estado, slint::GraphicsAPI) { if (estado == slint::RenderingState::AfterRendering) traza::Registro::global().frame_dibujado(); }))
+            std::cerr << "[Traza] El renderizador no avisa de cada cuadro; no se medirá entrada -> frame" << std::endl;
+    }
+
+    // Tamaño de letra del proyector medido con las métricas de Inter (font-weight 900 en projector_ui.slint)
+    AjusteTexto ajuste_texto(ruta_fuente_proyector(), 900.0f);
+    if (!ajuste_texto.fuente_cargada()) std::cerr << "[Proyector] No se pudo leer " << ruta_fuente_proyector() << "; se usa la escala por cantidad de caracteres" << std::endl;
+    // Al cargar un canto o un capítulo se calculan en segundo plano los tamaños de todas sus diapositivas;
+    // el pool recibe el mismo CapituloPtr o vector de diapositivas que muestra el panel
+    auto precalcular_tamanos = [&ajuste_texto, proyector](auto lista, bool con_referencia) {
+        ajuste_texto.precalcular(std::move(lista), area_texto_proyector(proyector, con_referencia));
+    };
+    // Tamaño de `texto` en el proyector sin medir en el hilo de la UI: si no estaba calculado se pone uno
+    // provisorio y el exacto llega del pool, salvo que para entonces ya se proyecte otro texto. El pool solo
+    // lleva el puntero a la ventana (no copia el handle de Slint fuera de este hilo); ajuste_texto se
+    // destruye antes que `proyector` y detiene su pool.
+    auto poner_tamano_letra = [&ajuste_texto, proyector](std::string texto, const AjusteTexto::Area& area) {
+        const ProjectorWindow* ventana = proyector.operator->();
+        proyector->set_tamano_letra(ajuste_texto.tamano_sin_esperar(texto, area, [ventana, texto](float tamano) {
+            slint::invoke_from_event_loop([ventana, texto, tamano]() { if (std::string_view(ventana->get_texto_proyeccion()) == texto) ventana->set_tamano_letra(tamano); });
+        }));
+    };
+
+    // El panel usa un único modelo: un canto, un capítulo o un cambio de versión reemplazan sus datos en el
+    // lugar. Los elementos de la lista de servicio traen su propio modelo ya armado y se muestran cambiando
+    // el puntero; al volver a la biblioteca se repone este.
+    auto modelo_panel = std::make_shared<ModeloDiapositivas>();
+    ui->set_estrofas_actuales(modelo_panel);
+    auto mostrar_en_panel = [ui, modelo_panel](auto contenido) {
+        modelo_panel->mostrar(std::move(contenido));
+        if (ui->get_estrofas_actuales() != modelo_panel) ui->set_estrofas_actuales(modelo_panel);
+    };
 
     auto current_biblia_libro = std::make_shared<int>(-1);
     auto current_biblia_capitulo = std::make_shared<int>(-1);
+    auto canto_actual = std::make_shared<int>(0);
+
+    // --- LISTA DE SERVICIO ---
+    // Lo que se va a mostrar en el culto se precarga en un lote de fondo: diapositivas (sin consultas
+    // en el hilo de la UI) y tamaños de letra; al terminar se arman los modelos de Slint de una vez.
+    // Un elemento nuevo se precarga solo y se agrega al final; cambiar de versión, editar o eliminar un
+    // canto de la lista o quitar un elemento vuelve a precargarla entera. La lista se lee al abrirse cantos.db (0 hasta entonces).
+    auto lista_servicio = std::make_shared<int>(0);
+    auto elementos_servicio = std::make_shared<std::vector<ElementoLista>>();
+    auto servicio = std::make_shared<std::vector<ElementoEnVivo>>();
+    auto modelo_servicio = std::make_shared<slint::VectorModel<ElementoServicio>>();
+    ui->set_lista_servicio(modelo_servicio);
+    // Solo se entrega la precarga completa más reciente (y los agregados posteriores a ella)
+    auto generacion_servicio = std::make_shared<std::atomic<uint64_t>>(0);
+    PoolTrabajo pool_servicio{1};
+
+    // Muestra el elemento `i` ya precargado: solo cambia punteros. Con `estrofa` >= 0 la proyecta.
+    auto mostrar_elemento_servicio = [ui, servicio, current_biblia_libro, current_biblia_capitulo](int i, int estrofa) {
+        if (i < 0 || i >= static_cast<int>(servicio->size())) { ui->set_elemento_servicio_activo(-1); return; }
+        const auto& e = (*servicio)[i];
+        *current_biblia_libro = -1; *current_biblia_capitulo = -1;
+        ui->set_elemento_servicio_activo(i);
+        ui->set_elemento_seleccionado(e.titulo); ui->set_estrofas_biblicas(e.biblico);
+        ui->set_estrofas_actuales(e.diapositivas);
+        ui->set_active_estrofa_index(estrofa); ui->set_scroll_to_y(0);
+        if (estrofa >= 0 && estrofa < static_cast<int>(e.diapositivas->row_count())) {
+            ui->invoke_proyectar_estrofa(slint::SharedString(e.diapositivas->texto(estrofa)), e.biblico ? slint::SharedString(std::string(e.titulo) + ":" + std::to_string(e.diapositivas->orden(estrofa))) : slint::SharedString());
+        }
+        ui->invoke_focus_panel();
+    };
 
-    auto cargar_cantos = [&app_state, ui](const std::string& busqueda) {
-        auto cantos_db = busqueda.empty() ? app_state.get_all_cantos() : app_state.get_cantos_filtrados(busqueda);
-        std::vector<Canto> cantos_slint;
-        if (cantos_db.empty()) cantos_slint.push_back(Canto{ 0, slint::SharedString("Click derecho para agregar canto"), slint::SharedString("") });
-        else for(const auto& c : cantos_db) cantos_slint.push_back(Canto{ c.id, slint::SharedString(c.titulo), slint::SharedString("") });
-        ui->set_cantos(std::make_shared<slint::VectorModel<Canto>>(cantos_slint));
+    // `completa`: reemplaza toda la lista; si no, los elementos se agregan al final de la actual
+    auto precargar_servicio = [&app_state, &ajuste_texto, &pool_servicio, ui, proyector, servicio, modelo_servicio, generacion_servicio, mostrar_elemento_servicio, marcar_arranque](std::vector<ElementoLista> elementos, bool completa) {
+        uint64_t gen = completa ? ++*generacion_servicio : generacion_servicio->load();
+        int version = app_state.get_current_version_id();
+        AjusteTexto::Area area_canto = area_texto_proyector(proyector, false), area_biblia = area_texto_proyector(proyector, true);
+        if (completa) pool_servicio.descartar_pendientes(PoolTrabajo::Prioridad::PrimerPlano);
+        pool_servicio.encolar([=, &app_state, &ajuste_texto, elementos = std::move(elementos)]() {
+            if (gen != *generacion_servicio) return;
+            auto inicio = std::chrono::steady_clock::now();
+            auto contenidos = std::make_shared<std::vector<ContenidoElemento>>(app_state.materializar_lista(elementos, version));
+            auto tamanos = std::make_shared<std::vector<std::vector<float>>>();
+            size_t diapositivas = 0;
+            for (const auto& c : *contenidos) {
+                auto& t = tamanos->emplace_back(); t.reserve(c.diapositivas.size()); diapositivas += c.diapositivas.size();
+                traza::Medicion m(traza::Etapa::Ajuste, "tamaños servicio");
+                for (const auto& d : c.diapositivas) t.push_back(ajuste_texto.tamano(d.texto, c.biblico ? area_biblia : area_canto));
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+            slint::invoke_from_event_loop([=, enviado = traza::marca()]() {
+                traza::registrar_desde(traza::Etapa::Salto, "servicio -> UI", enviado);
+                if (gen != *generacion_servicio) return;
+                traza::Medicion m(traza::Etapa::Modelo, "modelos servicio");
+                auto inicio_modelos = std::chrono::steady_clock::now();
+                std::vector<ElementoEnVivo> nuevos; std::vector<ElementoServicio> filas;
+                for (size_t i = 0; i < contenidos->size(); ++i) {
+                    auto& c = (*contenidos)[i];
+                    filas.push_back(ElementoServicio{ slint::SharedString(c.etiqueta), c.biblico, !c.diapositivas.empty() });
+                    auto modelo = std::make_shared<ModeloDiapositivas>(std::make_shared<const std::vector<Diapositiva>>(std::move(c.diapositivas)));
+                    nuevos.push_back({ slint::SharedString(c.titulo), c.biblico, std::move(modelo), std::move((*tamanos)[i]), c.biblico ? area_biblia : area_canto });
+                }
+                if (completa) {
+                    // Si el elemento en pantalla es de la lista, se vuelve a mostrar con el contenido nuevo
+                    int activo = ui->get_elemento_servicio_activo(), estrofa = ui->get_active_estrofa_index();
+                    *servicio = std::move(nuevos); modelo_servicio->set_vector(std::move(filas));
+                    if (activo >= 0) mostrar_elemento_servicio(activo, estrofa);
+                    marcar_arranque("servicio");
+                } else {
+                    for (size_t i = 0; i < nuevos.size(); ++i) { servicio->push_back(std::move(nuevos[i])); modelo_servicio->push_back(filas[i]); }
+                }
+                std::cout << "[Servicio] " << contenidos->size() << " elementos (" << diapositivas << " diapositivas) precargados en " << ms << " ms + "
+                          << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio_modelos).count() << " ms de modelos" << std::endl;
+            });
+        });
     };
-    cargar_cantos("");
 
-    ui->on_seleccionar_canto([ui, &app_state, current_biblia_libro, current_biblia_capitulo](int id) {
+    // La lista de cantos vive en un único modelo; las búsquedas corren en segundo plano
+    // y solo el resultado de la última tecla se aplica sobre él.
+    auto modelo_cantos = std::make_shared<slint::VectorModel<Canto>>();
+    ui->set_cantos(modelo_cantos);
+    // main es dueño del buscador: su hilo consulta app_state, así que se destruye (y se espera al hilo) al
+    // salir del bucle de eventos, antes que app_state. Los callbacks solo guardan el puntero; los que lleguen
+    // después de destruirlo lo encuentran vacío en buscador_slot.
+    using BuscadorCantos = BusquedaDiferida<std::vector<Canto>>;
+    auto buscador_slot = std::make_shared<BuscadorCantos*>(nullptr);
+    auto buscador = std::make_unique<BuscadorCantos>(
+        [&app_state](const std::string& busqueda) {
+            std::vector<Canto> cantos_slint;
+            if (busqueda.empty()) { for(const auto& c : app_state.get_all_cantos()) cantos_slint.push_back(Canto{ c.id, slint::SharedString(c.titulo), slint::SharedString("") }); }
+            else { for(const auto& c : app_state.get_cantos_filtrados(busqueda)) cantos_slint.push_back(Canto{ c.id, slint::SharedString(c.titulo), slint::SharedString(c.fragmento) }); }
+            if (cantos_slint.empty()) cantos_slint.push_back(Canto{ 0, slint::SharedString("Click derecho para agregar canto"), slint::SharedString("") });
+            return cantos_slint;
+        },
+        [modelo_cantos, buscador_slot, marcar_arranque](uint64_t gen, std::vector<Canto> cantos) {
+            slint::invoke_from_event_loop([modelo_cantos, buscador_slot, marcar_arranque, gen, cantos = std::move(cantos), enviado = traza::marca()]() mutable {
+                traza::registrar_desde(traza::Etapa::Salto, "búsqueda -> UI", enviado);
+                BuscadorCantos* buscador = *buscador_slot;
+                if (buscador && buscador->es_vigente(gen)) { actualizar_modelo_cantos(*modelo_cantos, std::move(cantos)); marcar_arranque("lista_cantos"); }
+            });
+        });
+    BuscadorCantos* buscador_cantos = buscador.get();
+    *buscador_slot = buscador_cantos;
+
+    ui->on_seleccionar_canto([ui, &app_state, current_biblia_libro, current_biblia_capitulo, canto_actual, precalcular_tamanos, mostrar_en_panel](int id) {
         if (id == 0) return; 
-        *current_biblia_libro = -1; *current_biblia_capitulo = -1;
+        traza::Medicion m(traza::Etapa::Entrada, "seleccionar_canto");
+        *current_biblia_libro = -1; *current_biblia_capitulo = -1; *canto_actual = id;
+        ui->set_elemento_servicio_activo(-1); ui->set_estrofas_biblicas(false);
         ui->set_elemento_seleccionado(slint::SharedString(app_state.get_canto_titulo(id)));
-        auto diapositivas = app_state.get_canto_diapositivas(id); std::vector<DiapositivaUI> diapos_slint;
-        for(const auto& dia : diapositivas) diapos_slint.push_back(DiapositivaUI{ slint::SharedString(std::to_string(dia.orden)), slint::SharedString(dia.texto) });
-        ui->set_estrofas_actuales(std::make_shared<slint::VectorModel<DiapositivaUI>>(diapos_slint));
-        ui->set_active_estrofa_index(-1); ui->invoke_focus_panel();
+        auto diapositivas = std::make_shared<const std::vector<Diapositiva>>(app_state.get_canto_diapositivas(id));
+        mostrar_en_panel(diapositivas);
+        precalcular_tamanos(std::move(diapositivas), false);
+        ui->set_active_estrofa_index(-1); ui->set_scroll_to_y(0); ui->invoke_focus_panel();
     });
 
-    ui->on_abrir_proyector([proyector]() mutable { proyector->window().set_position(slint::PhysicalPosition({1920, 0})); proyector->window().set_fullscreen(true); proyector->show(); });
-    
-    ui->on_proyectar_estrofa([proyector, &app_state](slint::SharedString texto, slint::SharedString referencia) mutable {
-        proyector->set_texto_proyeccion(texto); 
+    // --- IMÁGENES DE FONDO ---
+    // Catálogo de multimedia.db con miniaturas; los fondos se decodifican y escalan en los hilos de la
+    // galería, así que cambiar de fondo en pleno servicio solo asigna una imagen ya lista al proyector.
+    GaleriaImagenes galeria([](std::function<void()> trabajo) { slint::invoke_from_event_loop(std::move(trabajo)); });
+    auto catalogo_imagenes = std::make_shared<std::vector<ElementoMultimedia>>();
+    auto modelo_imagenes = std::make_shared<slint::VectorModel<ImagenMedio>>();
+    ui->set_imagenes(modelo_imagenes);
+    auto fondo_pedido = std::make_shared<ClaveFondo>(ClaveFondo{ -1, 0, 0 }); // id -1: sin fondo
+
+    // Los slint::Image se arman aquí, en el hilo de la interfaz, con los píxeles que decodificó la galería
+    auto poner_miniatura = [modelo_imagenes](int id, PixelesPtr miniatura) {
+        for (size_t i = 0; i < modelo_imagenes->row_count(); ++i) {
+            auto fila = modelo_imagenes->row_data(i);
+            if (fila && fila->id == id) { fila->miniatura = slint::Image(*miniatura); modelo_imagenes->set_row_data(i, *fila); return; }
+        }
+    };
+    auto agregar_al_catalogo = [&galeria, catalogo_imagenes, modelo_imagenes, poner_miniatura](std::vector<ElementoMultimedia> nuevas) {
+        for (const auto& e : nuevas) { catalogo_imagenes->push_back(e); modelo_imagenes->push_back(ImagenMedio{ e.id, slint::SharedString(e.nombre), slint::Image() }); }
+        galeria.miniaturas(std::move(nuevas), poner_miniatura);
+    };
 
-        std::string ref_str = std::string(referencia);
-    if (!ref_str.empty()) {
-        std::string sigla = get_sigla_version(app_state);
-        if (!sigla.empty()) ref_str = ref_str + "  |  " + sigla;
-        // Resultado final en proyector: "Ester 8:9  |  RVR"
-    }
+    // Pide el fondo al tamaño actual del proyector y precarga las imágenes vecinas de la galería
+    auto mostrar_fondo = [&galeria, ui, proyector, catalogo_imagenes, fondo_pedido](int id) {
+        ui->set_fondo_activo(id);
+        auto it = std::find_if(catalogo_imagenes->begin(), catalogo_imagenes->end(), [id](const ElementoMultimedia& e) { return e.id == id; });
+        if (it == catalogo_imagenes->end()) { galeria.cancelar_fondo(); *fondo_pedido = { -1, 0, 0 }; ui->set_fondo_activo(-1); proyector->set_con_fondo(false); return; }
+        *fondo_pedido = tamano_fondo_proyector(proyector, id);
+        galeria.fondo(*it, fondo_pedido->ancho, fondo_pedido->alto, [proyector](PixelesPtr pixeles) { if (pixeles) { proyector->set_fondo(slint::Image(*pixeles)); proyector->set_con_fondo(true); } });
+        std::vector<ElementoMultimedia> vecinas;
+        if (it + 1 != catalogo_imagenes->end()) vecinas.push_back(*(it + 1));
+        if (it != catalogo_imagenes->begin()) vecinas.push_back(*(it - 1));
+        galeria.precargar(vecinas, fondo_pedido->ancho, fondo_pedido->alto);
+    };
+    // Si la ventana del proyector cambió de tamaño desde que se pidió el fondo, se pide de nuevo
+    auto revisar_fondo = [proyector, fondo_pedido, mostrar_fondo]() {
+        if (fondo_pedido->imagen_id >= 0 && !(tamano_fondo_proyector(proyector, fondo_pedido->imagen_id) == *fondo_pedido)) mostrar_fondo(fondo_pedido->imagen_id);
+    };
 
-        proyector->set_referencia(referencia); 
-        
-        // --- REDIMENSIONAMIENTO INTELIGENTE ---
-        // Calculamos cuántos caracteres tiene el texto entrante
-        size_t len = std::string(texto).length();
-        float font_size = 85.0f; // Tamaño gigante para 1 o 2 líneas (ej: "Aleluya")
-        
-        // Escala calibrada dinámicamente:
-        if (len >= 450) font_size = 32.0f;       // Textos masivos (como Ester 8:9)
-        else if (len >= 320) font_size = 38.0f;  // Textos muy largos
-        else if (len >= 220) font_size = 46.0f;  // Textos largos
-        else if (len >= 120) font_size = 56.0f;  // Textos medianos
-        else if (len >= 60)  font_size = 68.0f;  // Textos cortos
-        
-        // Enviamos el tamaño calculado a la interfaz gráfica de Slint
-        proyector->set_tamano_letra(font_size); 
+    ui->on_fondo_seleccionar([mostrar_fondo](int id) { traza::entrada(); mostrar_fondo(id); });
+    ui->on_imagen_agregar([&galeria, ui, agregar_al_catalogo](slint::SharedString ruta) {
+        galeria.agregar(std::string(ruta), [ui, agregar_al_catalogo, ruta](std::vector<ElementoMultimedia> nuevas) {
+            if (nuevas.empty()) { std::cerr << "[Imágenes] No se agregó nada desde " << std::string_view(ruta) << std::endl; return; }
+            ui->set_ruta_imagen(""); agregar_al_catalogo(std::move(nuevas));
+        });
+    });
+    // El DELETE corre en el pool de la galería (multimedia.db puede estar ocupada importando una carpeta)
+    ui->on_imagen_quitar([&galeria, ui, catalogo_imagenes, modelo_imagenes, mostrar_fondo](int id) {
+        galeria.quitar(id, [ui, catalogo_imagenes, modelo_imagenes, mostrar_fondo, id](bool ok) {
+            if (!ok) { std::cerr << "[Imágenes] No se pudo quitar la imagen " << id << std::endl; return; }
+            catalogo_imagenes->erase(std::remove_if(catalogo_imagenes->begin(), catalogo_imagenes->end(), [id](const ElementoMultimedia& e) { return e.id == id; }), catalogo_imagenes->end());
+            for (size_t i = 0; i < modelo_imagenes->row_count(); ++i) if (modelo_imagenes->row_data(i)->id == id) { modelo_imagenes->erase(i); break; }
+            if (ui->get_fondo_activo() == id) mostrar_fondo(-1);
+        });
     });
 
-    auto versiones = app_state.get_versiones();
-    std::vector<slint::SharedString> versiones_slint;
-    // AQUÍ PASAMOS LOS NOMBRES COMPLETOS AL COMBOBOX
-    for (const auto& v : versiones) versiones_slint.push_back(slint::SharedString(v.nombre_completo));
-    ui->set_bible_versions(std::make_shared<slint::VectorModel<slint::SharedString>>(versiones_slint));
+    ui->on_abrir_proyector([proyector, revisar_fondo]() mutable {
+        proyector->window().set_position(slint::PhysicalPosition({1920, 0})); proyector->window().set_fullscreen(true); proyector->show();
+        // Ya con su tamaño de pantalla completa
+        slint::invoke_from_event_loop(revisar_fondo);
+    });
     
-    if (!versiones.empty()) { 
-        ui->set_current_bible_version(slint::SharedString(versiones[0].nombre_completo)); 
-        app_state.set_version_by_name(versiones[0].nombre_completo); 
-    }
+    ui->on_proyectar_estrofa([ui, proyector, servicio, poner_tamano_letra, revisar_fondo](slint::SharedString texto, slint::SharedString referencia) mutable {
+        traza::entrada(); traza::Medicion m(traza::Etapa::Proyeccion, "proyectar_estrofa");
+        revisar_fondo();
+        proyector->set_texto_proyeccion(texto); 
+        proyector->set_referencia(referencia);
+
+        // En la lista de servicio el tamaño ya viene calculado (salvo que el proyector haya cambiado de tamaño).
+        // Fuera de ella normalmente está precalculado; si no, se mide en el pool y mientras tanto va uno provisorio.
+        AjusteTexto::Area area = area_texto_proyector(proyector, !referencia.empty());
+        float tamano = 0; int elemento = ui->get_elemento_servicio_activo(), estrofa = ui->get_active_estrofa_index();
+        if (elemento >= 0 && elemento < static_cast<int>(servicio->size())) {
+            const auto& e = (*servicio)[elemento];
+            if (estrofa >= 0 && estrofa < static_cast<int>(e.tamanos.size()) && e.area.ancho == area.ancho && e.area.alto == area.alto) tamano = e.tamanos[estrofa];
+        }
+        if (tamano > 0) proyector->set_tamano_letra(tamano); else poner_tamano_letra(std::string(texto), area);
+    });
 
-    auto cargar_libros_biblia = [&app_state, ui]() {
-        auto libros = app_state.get_libros_biblia(); std::vector<BookInfo> libros_slint;
-        for(const auto& lib : libros) libros_slint.push_back(BookInfo{ lib.id, slint::SharedString(lib.nombre), lib.capitulos });
-        ui->set_bible_books(std::make_shared<slint::VectorModel<BookInfo>>(libros_slint));
+    // Se llama cuando biblias.db ya tiene sus versiones
+    auto cargar_versiones = [&app_state, ui]() {
+        auto versiones = app_state.get_versiones();
+        std::vector<slint::SharedString> versiones_slint;
+        // AQUÍ PASAMOS LOS NOMBRES COMPLETOS AL COMBOBOX
+        for (const auto& v : versiones) versiones_slint.push_back(slint::SharedString(v.nombre_completo));
+        ui->set_bible_versions(std::make_shared<slint::VectorModel<slint::SharedString>>(versiones_slint));
+
+        if (!versiones.empty()) {
+            ui->set_current_bible_version(slint::SharedString(versiones[0].nombre_completo));
+            app_state.set_version_by_name(versiones[0].nombre_completo);
+        }
+    };
+
+    // El modelo de libros de cada versión se arma la primera vez y se reutiliza al volver a ella.
+    // Mientras no llegan los metadatos no hay libros, y la lista vacía no se guarda.
+    auto modelos_libros = std::make_shared<std::unordered_map<int, std::shared_ptr<slint::VectorModel<BookInfo>>>>();
+    auto cargar_libros_biblia = [&app_state, ui, modelos_libros]() {
+        auto& modelo = (*modelos_libros)[app_state.get_current_version_id()];
+        if (!modelo || modelo->row_count() == 0) {
+            std::vector<BookInfo> libros_slint;
+            for(const auto& lib : app_state.get_libros_biblia()) libros_slint.push_back(BookInfo{ lib.id, slint::SharedString(lib.nombre), lib.capitulos });
+            modelo = std::make_shared<slint::VectorModel<BookInfo>>(libros_slint);
+        }
+        ui->set_bible_books(modelo);
     };
-    cargar_libros_biblia();
 
     // AQUÍ EL CALLBACK RECIBE EL NOMBRE COMPLETO ("Reina Valera 1960") DESDE EL COMBOBOX
-    ui->on_bible_version_changed([&app_state, ui, proyector, cargar_libros_biblia, current_biblia_libro, current_biblia_capitulo](slint::SharedString name) mutable {
+    ui->on_bible_version_changed([&app_state, ui, proyector, cargar_libros_biblia, current_biblia_libro, current_biblia_capitulo, precalcular_tamanos, poner_tamano_letra, mostrar_en_panel, elementos_servicio, precargar_servicio](slint::SharedString name) mutable {
+        traza::entrada(); traza::Medicion m(traza::Etapa::Entrada, "bible_version_changed");
         app_state.set_version_by_name(std::string(name));
         cargar_libros_biblia();
+        // Las lecturas de la lista de servicio pasan a la nueva versión
+        if (std::any_of(elementos_servicio->begin(), elementos_servicio->end(), [](const ElementoLista& e) { return e.canto_id == 0; })) precargar_servicio(*elementos_servicio, true);
 
         if (*current_biblia_libro != -1 && *current_biblia_capitulo != -1) {
             int active_idx = ui->get_active_estrofa_index();
-            app_state.get_capitulo_async(*current_biblia_libro, *current_biblia_capitulo, [ui, proyector, active_idx](std::vector<Versiculo> versiculos) {
-                std::vector<DiapositivaUI> diapos_slint;
-                for(const auto& v : versiculos) diapos_slint.push_back(DiapositivaUI{ slint::SharedString(std::to_string(v.versiculo)), slint::SharedString(v.texto) });
-                ui->set_estrofas_actuales(std::make_shared<slint::VectorModel<DiapositivaUI>>(diapos_slint));
-                if (active_idx >= 0 && active_idx < versiculos.size()) proyector->set_texto_proyeccion(slint::SharedString(versiculos[active_idx].texto));
+            // Mismo capítulo en otra versión: las filas se actualizan en su lugar y el ListView no se rearma
+            app_state.get_capitulo_async(*current_biblia_libro, *current_biblia_capitulo, [proyector, active_idx, precalcular_tamanos, poner_tamano_letra, mostrar_en_panel](CapituloPtr capitulo) {
+                traza::Medicion m(traza::Etapa::Modelo, "estrofas capítulo");
+                const auto& versiculos = *capitulo;
+                mostrar_en_panel(capitulo);
+                // Primero la precarga del capítulo en la nueva versión: el versículo activo se mide detrás de ella
+                precalcular_tamanos(capitulo, true);
+                if (active_idx >= 0 && active_idx < static_cast<int>(versiculos.size())) {
+                    proyector->set_texto_proyeccion(slint::SharedString(versiculos[active_idx].texto));
+                    poner_tamano_letra(versiculos[active_idx].texto, area_texto_proyector(proyector, true));
+                }
             });
         }
     });
@@ -374,46 +441,48 @@ int main() {
         else ui->set_bible_search_suggestion("");
     });
 
-    ui->on_bible_search_accepted([&app_state, ui, current_biblia_libro, current_biblia_capitulo](slint::SharedString query) {
-        std::string q = std::string(query);
-        std::regex re(R"(^\s*(.*?)\s+(\d+)(?:\s+(\d+))?\s*$)"); 
-        std::smatch match;
+    ui->on_bible_search_accepted([&app_state, ui, current_biblia_libro, current_biblia_capitulo, precalcular_tamanos, mostrar_en_panel](slint::SharedString query) {
+        traza::entrada(); traza::Medicion m(traza::Etapa::Entrada, "bible_search_accepted");
+        // "Jn 3:16", "1 Co 13:4-7", "Sal 23, 1-3". Con varias referencias ("Jn 3:16; Ro 8:28") se abre
+        // la primera y las demás quedan en el buscador para el siguiente Enter. Sin libro ("4:8")
+        // se usa el libro abierto.
+        std::string q = std::string(query); std::string_view pendiente = q;
+        ReferenciaBiblica ref;
 
-        if (std::regex_match(q, match, re)) {
-            std::string book_query = match[1].str();
-            int capitulo = std::stoi(match[2].str());
-            int versiculo_objetivo = match[3].matched ? std::stoi(match[3].str()) : 1;
+        if (leer_referencia(pendiente, ref)) {
+            int capitulo = ref.capitulo;
+            int versiculo_objetivo = ref.verso_inicio > 0 ? ref.verso_inicio : 1;
 
             int libro_id = -1;
-            std::string libro_nombre_real = buscar_libro_inteligente(book_query, libro_id);
+            std::string libro_nombre_real;
+            if (!ref.libro.empty()) libro_nombre_real = buscar_libro_inteligente(ref.libro, libro_id);
+            else if (*current_biblia_libro >= 1 && *current_biblia_libro <= static_cast<int>(NOMBRES_LIBROS.size())) { libro_id = *current_biblia_libro; libro_nombre_real = NOMBRES_LIBROS[libro_id - 1]; }
 
             if (libro_id != -1) {
+                std::string_view resto = referencia::recortar(pendiente); ReferenciaBiblica siguiente;
+                if (!resto.empty()) {
+                    std::string_view prueba = resto;
+                    bool sin_libro = leer_referencia(prueba, siguiente) && siguiente.libro.empty();
+                    ui->set_bible_search_text(slint::SharedString((sin_libro ? libro_nombre_real + " " : std::string()) + std::string(resto)));
+                }
                 *current_biblia_libro = libro_id;
                 *current_biblia_capitulo = capitulo;
+                ui->set_elemento_servicio_activo(-1); ui->set_estrofas_biblicas(true);
                 std::string titulo = libro_nombre_real + " " + std::to_string(capitulo);
                 
                 ui->set_elemento_seleccionado(slint::SharedString(titulo));
 
-                app_state.get_capitulo_async(libro_id, capitulo, [ui, versiculo_objetivo, titulo](std::vector<Versiculo> versiculos) {
-                    std::vector<DiapositivaUI> diapos_slint;
+                app_state.get_capitulo_async(libro_id, capitulo, [ui, versiculo_objetivo, titulo, precalcular_tamanos, mostrar_en_panel](CapituloPtr capitulo_cargado) {
+                    traza::Medicion m(traza::Etapa::Modelo, "estrofas capítulo");
+                    const auto& versiculos = *capitulo_cargado;
                     int target_index = 0;
-                    int current_idx = 0;
-                    
-                    // CORRECCIÓN: Cargamos TODOS los versículos para que el Scroll funcione
-                    for(const auto& v : versiculos) {
-                        diapos_slint.push_back(DiapositivaUI{ 
-                            slint::SharedString(std::to_string(v.versiculo)), 
-                            slint::SharedString(v.texto) 
-                        });
-                        
-                        // Capturamos el índice exacto del versículo buscado
-                        if (v.versiculo == versiculo_objetivo) {
-                            target_index = current_idx;
-                        }
-                        current_idx++;
-                    }
-                    
-                    ui->set_estrofas_actuales(std::make_shared<slint::VectorModel<DiapositivaUI>>(diapos_slint));
+
+                    // Capturamos el índice exacto del versículo buscado
+                    for (size_t i = 0; i < versiculos.size(); ++i) if (versiculos[i].versiculo == versiculo_objetivo) { target_index = static_cast<int>(i); break; }
+
+                    // Todos los versículos quedan en el modelo para que el Scroll funcione
+                    mostrar_en_panel(capitulo_cargado);
+                    precalcular_tamanos(capitulo_cargado, true);
                     
                     // CORRECCIÓN: Le decimos a Slint cuál es el activo, pero manteniendo toda la lista
                     ui->set_active_estrofa_index(target_index); 
@@ -422,8 +491,8 @@ int main() {
                     float scroll_y = target_index * ITEM_HEIGHT;
                     ui->set_scroll_to_y(scroll_y); 
                         
-                    if (!diapos_slint.empty() && target_index < diapos_slint.size()) {
-                        ui->invoke_proyectar_estrofa(diapos_slint[target_index].texto, slint::SharedString(titulo + ":" + std::string(diapos_slint[target_index].orden)));
+                    if (target_index < static_cast<int>(versiculos.size())) {
+                        ui->invoke_proyectar_estrofa(slint::SharedString(versiculos[target_index].texto), slint::SharedString(titulo + ":" + std::to_string(versiculos[target_index].versiculo)));
                     }
                     ui->invoke_focus_panel();
                 });
@@ -431,7 +500,11 @@ int main() {
             }
         }
     });
-    ui->on_bible_book_selected([ui](BookInfo book) {
+    // La grilla de capítulos solo depende de cuántos capítulos tiene el libro: una por cantidad
+    auto grillas_capitulos = std::make_shared<std::unordered_map<int, std::shared_ptr<slint::VectorModel<ChapterRow>>>>();
+    ui->on_bible_book_selected([ui, grillas_capitulos](BookInfo book) {
+        auto& grilla = (*grillas_capitulos)[book.capitulos];
+        if (grilla) { ui->set_chapter_rows(grilla); return; }
         std::vector<ChapterRow> filas; std::vector<int> fila_actual;
         for (int i = 1; i <= book.capitulos; ++i) {
             fila_actual.push_back(i);
@@ -440,26 +513,30 @@ int main() {
                 for(int cap : fila_actual) fila_slint->push_back(cap);
                 filas.push_back(ChapterRow{ fila_slint }); fila_actual.clear();
             }
-        } ui->set_chapter_rows(std::make_shared<slint::VectorModel<ChapterRow>>(filas));
+        } grilla = std::make_shared<slint::VectorModel<ChapterRow>>(filas);
+        ui->set_chapter_rows(grilla);
     });
 
-    ui->on_bible_chapter_selected([ui, &app_state, current_biblia_libro, current_biblia_capitulo](int cap) {
+    ui->on_bible_chapter_selected([ui, &app_state, current_biblia_libro, current_biblia_capitulo, precalcular_tamanos, mostrar_en_panel](int cap) {
+        traza::entrada(); traza::Medicion m(traza::Etapa::Entrada, "bible_chapter_selected");
         BookInfo book = ui->get_selected_bible_book();
         *current_biblia_libro = book.id; *current_biblia_capitulo = cap;
+        ui->set_elemento_servicio_activo(-1); ui->set_estrofas_biblicas(true);
         std::string titulo = std::string(book.nombre) + " " + std::to_string(cap);
         
-        app_state.get_capitulo_async(book.id, cap, [ui, titulo](std::vector<Versiculo> versiculos) {
+        app_state.get_capitulo_async(book.id, cap, [ui, titulo, precalcular_tamanos, mostrar_en_panel](CapituloPtr capitulo) {
+            traza::Medicion m(traza::Etapa::Modelo, "estrofas capítulo");
+            const auto& versiculos = *capitulo;
             ui->set_elemento_seleccionado(slint::SharedString(titulo)); 
-            std::vector<DiapositivaUI> diapos_slint;
-            for(const auto& v : versiculos) diapos_slint.push_back(DiapositivaUI{ slint::SharedString(std::to_string(v.versiculo)), slint::SharedString(v.texto) });
-            ui->set_estrofas_actuales(std::make_shared<slint::VectorModel<DiapositivaUI>>(diapos_slint));
-            ui->set_active_estrofa_index(0);
+            mostrar_en_panel(capitulo);
+            precalcular_tamanos(capitulo, true);
+            ui->set_active_estrofa_index(0); ui->set_scroll_to_y(0);
             if (!versiculos.empty()) ui->invoke_proyectar_estrofa(slint::SharedString(versiculos[0].texto), slint::SharedString(titulo + ":" + std::to_string(versiculos[0].versiculo)));
             ui->invoke_focus_panel();
         });
     });
 
-    ui->on_buscar_cantos([cargar_cantos](slint::SharedString texto) { cargar_cantos(std::string(texto)); });
+    ui->on_buscar_cantos([buscador_cantos](slint::SharedString texto) { traza::Medicion m(traza::Etapa::Entrada, "buscar_cantos"); buscador_cantos->buscar(std::string(texto)); });
 
     ui->on_cargar_datos_edicion([ui, &app_state](int id) {
         std::string titulo = app_state.get_canto_titulo(id); auto diapositivas = app_state.get_canto_diapositivas(id);
@@ -467,12 +544,99 @@ int main() {
         ui->set_form_id(id); ui->set_form_titulo(slint::SharedString(titulo)); ui->set_form_letra(slint::SharedString(letra_completa)); ui->set_mostrar_formulario(true);
     });
 
-    ui->on_guardar_canto([&app_state, cargar_cantos](int id, slint::SharedString titulo, slint::SharedString letra) {
-        if (id == -1) app_state.add_canto(std::string(titulo), std::string(letra)); else app_state.update_canto(id, std::string(titulo), std::string(letra)); cargar_cantos("");
+    ui->on_guardar_canto([&app_state, buscador_cantos, elementos_servicio, precargar_servicio](int id, slint::SharedString titulo, slint::SharedString letra) {
+        if (id == -1) app_state.add_canto(std::string(titulo), std::string(letra)); else app_state.update_canto(id, std::string(titulo), std::string(letra)); buscador_cantos->buscar("", true);
+        if (std::any_of(elementos_servicio->begin(), elementos_servicio->end(), [id](const ElementoLista& e) { return e.canto_id == id; })) precargar_servicio(*elementos_servicio, true);
+    });
+
+    ui->on_eliminar_canto([&app_state, ui, buscador_cantos, elementos_servicio, servicio, modelo_servicio, precargar_servicio](int id) {
+        app_state.delete_canto(id); buscador_cantos->buscar("", true);
+        // delete_canto ya lo quitó de las listas guardadas; aquí se quita de la precargada
+        bool quitado = false;
+        for (size_t i = elementos_servicio->size(); i-- > 0;) {
+            if ((*elementos_servicio)[i].canto_id != id) continue;
+            elementos_servicio->erase(elementos_servicio->begin() + i); quitado = true;
+            if (i < servicio->size()) { servicio->erase(servicio->begin() + i); modelo_servicio->erase(i); }
+            int activo = ui->get_elemento_servicio_activo();
+            if (activo == static_cast<int>(i)) ui->set_elemento_servicio_activo(-1); else if (activo > static_cast<int>(i)) ui->set_elemento_servicio_activo(activo - 1);
+        }
+        // Una precarga o un agregado que todavía esté en el pool se armó con la lista anterior: se descarta
+        // (nueva generación) y la lista se vuelve a precargar tal como quedó
+        if (quitado) precargar_servicio(*elementos_servicio, true);
+    });
+
+    ui->on_servicio_seleccionar([servicio, mostrar_elemento_servicio](int i) {
+        if (i < 0 || i >= static_cast<int>(servicio->size())) return;
+        traza::Medicion m(traza::Etapa::Entrada, "servicio_seleccionar");
+        mostrar_elemento_servicio(i, (*servicio)[i].biblico ? 0 : -1);
+    });
+
+    // Agrega lo que está en pantalla: el pasaje abierto (con el versículo activo), el canto o, si ya es
+    // un elemento de la lista, una copia suya
+    ui->on_servicio_agregar_actual([&app_state, ui, lista_servicio, elementos_servicio, current_biblia_libro, current_biblia_capitulo, canto_actual, precargar_servicio]() {
+        if (*lista_servicio == 0) return; // cantos.db todavía no está abierta
+        ElementoLista elemento{ 0, "" };
+        int activo = ui->get_elemento_servicio_activo();
+        if (activo >= 0 && activo < static_cast<int>(elementos_servicio->size())) elemento = (*elementos_servicio)[activo];
+        else if (*current_biblia_libro >= 1 && *current_biblia_libro <= static_cast<int>(NOMBRES_LIBROS.size()) && *current_biblia_capitulo >= 1) {
+            elemento.referencia = NOMBRES_LIBROS[*current_biblia_libro - 1] + " " + std::to_string(*current_biblia_capitulo);
+            auto estrofas = ui->get_estrofas_actuales(); int estrofa = ui->get_active_estrofa_index();
+            if (estrofas && estrofa >= 0 && estrofa < static_cast<int>(estrofas->row_count())) elemento.referencia += ":" + std::string(estrofas->row_data(estrofa)->orden);
+        }
+        else if (*canto_actual > 0) elemento.canto_id = *canto_actual;
+        else return;
+        elementos_servicio->push_back(elemento);
+        if (!app_state.guardar_elementos_lista(*lista_servicio, *elementos_servicio)) std::cerr << "[Servicio] No se pudo guardar la lista" << std::endl;
+        precargar_servicio({ elemento }, false);
+    });
+
+    ui->on_servicio_quitar([&app_state, ui, lista_servicio, elementos_servicio, servicio, modelo_servicio, precargar_servicio](int i) {
+        if (i < 0 || i >= static_cast<int>(servicio->size()) || i >= static_cast<int>(elementos_servicio->size())) return;
+        elementos_servicio->erase(elementos_servicio->begin() + i); servicio->erase(servicio->begin() + i); modelo_servicio->erase(i);
+        if (!app_state.guardar_elementos_lista(*lista_servicio, *elementos_servicio)) std::cerr << "[Servicio] No se pudo guardar la lista" << std::endl;
+        int activo = ui->get_elemento_servicio_activo();
+        if (activo == i) ui->set_elemento_servicio_activo(-1); else if (activo > i) ui->set_elemento_servicio_activo(activo - 1);
+        // Igual que al eliminar un canto: lo pendiente en el pool ya no coincide con la lista
+        precargar_servicio(*elementos_servicio, true);
+    });
+
+    // --- ARRANQUE ---
+    // La ventana se muestra enseguida y las bases se abren en segundo plano; cada parte de la interfaz se
+    // llena cuando llega su etapa. La lista de servicio necesita los cantos y la versión actual.
+    auto etapas_abiertas = std::make_shared<std::vector<Apertura>>();
+    app_state.abrir_en_segundo_plano([&app_state, ui, etapas_abiertas, lista_servicio, elementos_servicio, precargar_servicio, buscador_cantos, cargar_versiones, cargar_libros_biblia, marcar_arranque](Apertura etapa) {
+        etapas_abiertas->push_back(etapa);
+        switch (etapa) {
+            case Apertura::Cantos:
+                marcar_arranque("cantos_db");
+                *lista_servicio = app_state.get_lista_servicio();
+                *elementos_servicio = app_state.get_elementos_lista(*lista_servicio);
+                buscador_cantos->buscar(std::string(ui->get_buscador_texto()), true);
+                break;
+            case Apertura::Versiones: marcar_arranque("versiones"); cargar_versiones(); break;
+            case Apertura::Libros: cargar_libros_biblia(); marcar_arranque("libros"); break;
+        }
+        auto abierta = [&](Apertura e) { return std::find(etapas_abiertas->begin(), etapas_abiertas->end(), e) != etapas_abiertas->end(); };
+        if (etapa != Apertura::Libros && abierta(Apertura::Cantos) && abierta(Apertura::Versiones)) precargar_servicio(*elementos_servicio, true);
     });
 
-    ui->on_eliminar_canto([&app_state, cargar_cantos](int id) { app_state.delete_canto(id); cargar_cantos(""); });
+    galeria.abrir(app_state.directorio_datos() + "multimedia.db", agregar_al_catalogo);
 
     ui->run();
+    *buscador_slot = nullptr; buscador.reset();
+
+    auto stats_sql = app_state.get_estadisticas_sentencias();
+    std::cout << "[SQL] Sentencias preparadas: " << stats_sql.preparadas << " | reutilizadas: " << stats_sql.reutilizadas << std::endl;
+    auto stats_lectores = app_state.get_estadisticas_lectores();
+    std::cout << "[SQL] Lectores: " << stats_lectores.conexiones << " conexiones | " << stats_lectores.prestamos << " préstamos | " << stats_lectores.esperas << " esperaron una conexión libre" << std::endl;
+    auto stats_cache = app_state.get_estadisticas_cache();
+    std::cout << "[Cache] Capítulos: " << stats_cache.aciertos << " aciertos | " << stats_cache.fallos << " fallos | " << stats_cache.expulsiones << " expulsiones | "
+              << stats_cache.precargas_usadas << "/" << stats_cache.precargas << " precargas usadas | "
+              << stats_cache.entradas << " en memoria (" << stats_cache.bytes / 1024 << " de " << stats_cache.presupuesto / 1024 << " KB)" << std::endl;
+    auto stats_fondos = galeria.get_estadisticas();
+    std::cout << "[Cache] Fondos: " << stats_fondos.aciertos << " aciertos | " << stats_fondos.fallos << " fallos | " << stats_fondos.expulsiones << " expulsiones | "
+              << stats_fondos.precargas_usadas << "/" << stats_fondos.precargas << " precargas usadas | "
+              << stats_fondos.entradas << " en memoria (" << stats_fondos.bytes / (1024 * 1024) << " de " << stats_fondos.presupuesto / (1024 * 1024) << " MB)" << std::endl;
+    traza::Registro::global().exportar();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "multimedia.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+const char* tabla(TipoMultimedia tipo) { return tipo == TipoMultimedia::Imagen ? "imagenes" : tipo == TipoMultimedia::Video ? "videos" : "pdfs"; }
+}
+
+bool Multimedia::abrir(const std::string& ruta) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (sqlite3_open(ruta.c_str(), &db) != SQLITE_OK) { std::cerr << "[Multimedia] No se pudo abrir " << ruta << std::endl; sqlite3_close(db); db = nullptr; return false; }
+    sqlite3_exec(db, "PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;", nullptr, nullptr, nullptr);
+    const char* esquema =
+        "CREATE TABLE IF NOT EXISTS imagenes (id INTEGER PRIMARY KEY AUTOINCREMENT, nombre TEXT NOT NULL, ruta TEXT NOT NULL, aspecto TEXT DEFAULT 'contain');"
+        "CREATE TABLE IF NOT EXISTS videos (id INTEGER PRIMARY KEY AUTOINCREMENT, nombre TEXT NOT NULL, ruta TEXT NOT NULL, bucle INTEGER DEFAULT 0);"
+        "CREATE TABLE IF NOT EXISTS pdfs (id INTEGER PRIMARY KEY AUTOINCREMENT, nombre TEXT NOT NULL, ruta TEXT NOT NULL);"
+        "CREATE TABLE IF NOT EXISTS miniaturas (imagen_id INTEGER PRIMARY KEY, tamano_archivo INTEGER NOT NULL, modificado INTEGER NOT NULL, ancho INTEGER NOT NULL, alto INTEGER NOT NULL, jpeg BLOB NOT NULL);";
+    if (sqlite3_exec(db, esquema, nullptr, nullptr, nullptr) != SQLITE_OK) std::cerr << "[Multimedia] No se pudieron crear las tablas: " << sqlite3_errmsg(db) << std::endl;
+    sql.set_conexion(db);
+    return true;
+}
+
+void Multimedia::cerrar() {
+    std::lock_guard<std::mutex> lock(mtx);
+    sql.finalizar();
+    if (db) sqlite3_close(db);
+    db = nullptr;
+}
+
+std::vector<ElementoMultimedia> Multimedia::listar(TipoMultimedia tipo) {
+    std::lock_guard<std::mutex> lock(mtx); std::vector<ElementoMultimedia> lista;
+    // Columnas comunes más la propia de cada tabla, en la misma posición
+    std::string consulta = std::string("SELECT id, nombre, ruta, ") + (tipo == TipoMultimedia::Imagen ? "aspecto" : tipo == TipoMultimedia::Video ? "bucle" : "NULL") + " FROM " + tabla(tipo) + " ORDER BY nombre";
+    SentenciaUso stmt(sql, consulta);
+    if (stmt) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            ElementoMultimedia e; e.id = sqlite3_column_int(stmt, 0);
+            const char* nombre = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)); const char* ruta = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+            e.nombre = nombre ? nombre : ""; e.ruta = ruta ? ruta : "";
+            if (tipo == TipoMultimedia::Imagen) { const char* aspecto = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)); e.aspecto = aspecto ? aspecto : "contain"; }
+            else if (tipo == TipoMultimedia::Video) e.bucle = sqlite3_column_int(stmt, 3) != 0;
+            lista.push_back(std::move(e));
+        }
+    } return lista;
+}
+
+std::vector<ElementoMultimedia> Multimedia::agregar_imagenes(const std::string& ruta) {
+    std::vector<std::string> archivos; std::error_code ec;
+    fs::path origen = fs::absolute(ruta, ec);
+    if (fs::is_directory(origen, ec)) {
+        for (const auto& entrada : fs::directory_iterator(origen, ec)) if (entrada.is_regular_file(ec) && imagenes::es_imagen(entrada.path().string())) archivos.push_back(entrada.path().string());
+        std::sort(archivos.begin(), archivos.end());
+    } else if (fs::is_regular_file(origen, ec) && imagenes::es_imagen(origen.string())) archivos.push_back(origen.string());
+
+    std::vector<ElementoMultimedia> nuevas;
+    std::lock_guard<std::mutex> lock(mtx); if (!db || archivos.empty()) return nuevas;
+    Transaccion tx(db);
+    for (const auto& archivo : archivos) {
+        { SentenciaUso existe(sql, "SELECT 1 FROM imagenes WHERE ruta = ?"); if (!existe) break; sqlite3_bind_text(existe, 1, archivo.c_str(), -1, SQLITE_TRANSIENT); if (sqlite3_step(existe) == SQLITE_ROW) continue; }
+        // El aspecto queda con el valor por defecto de la tabla
+        SentenciaUso stmt(sql, "INSERT INTO imagenes (nombre, ruta) VALUES (?, ?)"); if (!stmt) break;
+        std::string nombre = fs::path(archivo).stem().string();
+        sqlite3_bind_text(stmt, 1, nombre.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 2, archivo.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) != SQLITE_DONE) continue;
+        nuevas.push_back({ static_cast<int>(sqlite3_last_insert_rowid(db)), nombre, archivo, "contain", false });
+    }
+    if (!tx.confirmar()) { std::cerr << "[Multimedia] No se pudieron agregar las imágenes: " << sqlite3_errmsg(db) << std::endl; nuevas.clear(); }
+    return nuevas;
+}
+
+bool Multimedia::quitar(TipoMultimedia tipo, int id) {
+    std::lock_guard<std::mutex> lock(mtx); Transaccion tx(db);
+    { SentenciaUso stmt(sql, std::string("DELETE FROM ") + tabla(tipo) + " WHERE id = ?"); if (!stmt) return false; sqlite3_bind_int(stmt, 1, id); if (sqlite3_step(stmt) != SQLITE_DONE) return false; }
+    if (tipo == TipoMultimedia::Imagen) { SentenciaUso stmt(sql, "DELETE FROM miniaturas WHERE imagen_id = ?"); if (!stmt) return false; sqlite3_bind_int(stmt, 1, id); if (sqlite3_step(stmt) != SQLITE_DONE) return false; }
+    return tx.confirmar();
+}
+
+void Multimedia::guardar_miniatura(int imagen_id, uint64_t tamano_archivo, int64_t modificado, uint32_t ancho, uint32_t alto, const std::vector<uint8_t>& jpeg) {
+    std::lock_guard<std::mutex> lock(mtx);
+    // Si la imagen se quitó mientras se generaba la miniatura, no queda una fila huérfana
+    SentenciaUso stmt(sql, "INSERT OR REPLACE INTO miniaturas (imagen_id, tamano_archivo, modificado, ancho, alto, jpeg) SELECT ?1, ?2, ?3, ?4, ?5, ?6 WHERE EXISTS (SELECT 1 FROM imagenes WHERE id = ?1)"); if (!stmt) return;
+    sqlite3_bind_int(stmt, 1, imagen_id); sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(tamano_archivo)); sqlite3_bind_int64(stmt, 3, modificado);
+    sqlite3_bind_int(stmt, 4, static_cast<int>(ancho)); sqlite3_bind_int(stmt, 5, static_cast<int>(alto));
+    sqlite3_bind_blob(stmt, 6, jpeg.data(), static_cast<int>(jpeg.size()), SQLITE_STATIC);
+    if (sqlite3_step(stmt) != SQLITE_DONE) std::cerr << "[Multimedia] No se pudo guardar la miniatura de " << imagen_id << ": " << sqlite3_errmsg(db) << std::endl;
+}
+
+imagenes::Resultado Multimedia::miniatura(const ElementoMultimedia& imagen, const imagenes::Reservar& reservar) {
+    std::error_code ec; imagenes::Resultado r;
+    uint64_t tamano = fs::file_size(imagen.ruta, ec);
+    if (ec) { r.error = "no existe " + imagen.ruta; return r; }
+    int64_t modificado = static_cast<int64_t>(fs::last_write_time(imagen.ruta, ec).time_since_epoch().count());
+
+    std::vector<uint8_t> guardada;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        SentenciaUso stmt(sql, "SELECT jpeg FROM miniaturas WHERE imagen_id = ? AND tamano_archivo = ? AND modificado = ? AND ancho = ? AND alto = ?");
+        if (stmt) {
+            sqlite3_bind_int(stmt, 1, imagen.id); sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(tamano)); sqlite3_bind_int64(stmt, 3, modificado);
+            sqlite3_bind_int(stmt, 4, MINIATURA_ANCHO); sqlite3_bind_int(stmt, 5, MINIATURA_ALTO);
+            if (sqlite3_step(stmt) == SQLITE_ROW) { auto* datos = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, 0)); guardada.assign(datos, datos + sqlite3_column_bytes(stmt, 0)); }
+        }
+    }
+    if (!guardada.empty()) { r = imagenes::decodificar(guardada, MINIATURA_ANCHO, MINIATURA_ALTO, imagenes::Ajuste::Cubrir, reservar); if (r.ok) return r; }
+
+    // Se genera: los píxeles quedan en el buffer de quien llama y se guarda una copia comprimida
+    uint8_t* pixeles = nullptr;
+    r = imagenes::decodificar_archivo(imagen.ruta, MINIATURA_ANCHO, MINIATURA_ALTO, imagenes::Ajuste::Cubrir, [&](uint32_t ancho, uint32_t alto) { return pixeles = reservar(ancho, alto); });
+    if (!r.ok) return r;
+    auto jpeg = imagenes::codificar_jpeg(pixeles, r.ancho, r.alto);
+    if (!jpeg.empty()) guardar_miniatura(imagen.id, tamano, modificado, r.ancho, r.alto, jpeg);
+    return r;
+}
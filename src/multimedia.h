@@ -0,0 +1,51 @@
+#pragma once
+#include "conexiones_sqlite.h"
+#include "imagenes.h"
+#include <sqlite3.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class TipoMultimedia { Imagen, Video, Pdf };
+
+// Fila de multimedia.db. Los archivos no se copian: `ruta` apunta al original.
+// `aspecto` solo lo usan las imágenes ("contain", "cover", "fill") y `bucle` solo los videos.
+struct ElementoMultimedia { int id = 0; std::string nombre; std::string ruta; std::string aspecto; bool bucle = false; };
+
+// Catálogo de multimedia.db (imagenes, videos, pdfs) y miniaturas de las imágenes. Las miniaturas se
+// guardan como JPEG en la tabla miniaturas junto con el tamaño y la fecha del archivo del que salieron:
+// si el archivo cambia, se regeneran. Una sola conexión con un mutex (las consultas son pocas y cortas);
+// se usa desde los hilos de trabajo de la galería, nunca desde el de la interfaz.
+class Multimedia {
+private:
+    sqlite3* db = nullptr;
+    std::mutex mtx;
+    CacheSentencias sql;
+
+    void guardar_miniatura(int imagen_id, uint64_t tamano_archivo, int64_t modificado, uint32_t ancho, uint32_t alto, const std::vector<uint8_t>& jpeg);
+
+public:
+    // 16:9 como el proyector; la galería las muestra recortadas a su celda
+    static constexpr uint32_t MINIATURA_ANCHO = 256;
+    static constexpr uint32_t MINIATURA_ALTO = 144;
+
+    Multimedia() = default;
+    ~Multimedia() { cerrar(); }
+    Multimedia(const Multimedia&) = delete;
+    Multimedia& operator=(const Multimedia&) = delete;
+
+    // Abre (o crea) la base; las tablas que falten se crean con el mismo esquema que trae la app
+    bool abrir(const std::string& ruta);
+    void cerrar();
+
+    std::vector<ElementoMultimedia> listar(TipoMultimedia tipo);
+    // Una imagen o todas las JPEG/PNG de una carpeta (sin subcarpetas), con el nombre del archivo.
+    // Las que ya están en el catálogo se saltan. Devuelve las agregadas.
+    std::vector<ElementoMultimedia> agregar_imagenes(const std::string& ruta);
+    bool quitar(TipoMultimedia tipo, int id);
+
+    // Miniatura RGBA de la imagen en el buffer de `reservar`: la guardada si sigue vigente; si no, se
+    // genera desde el archivo y se guarda. La decodificación ocurre fuera del mutex.
+    imagenes::Resultado miniatura(const ElementoMultimedia& imagen, const imagenes::Reservar& reservar);
+};
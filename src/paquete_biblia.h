@@ -0,0 +1,280 @@
+#pragma once
+#include <sqlite3.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Paquete binario de solo lectura con todas las versiones de biblias.db, pensado para mapearse
+// en memoria (mmap) y leerse sin copias. Se genera con la herramienta biblia_pack.
+//
+// Disposición (enteros little-endian, secciones alineadas a 8 bytes):
+//   CabeceraPaquete
+//   VersionPaquete[num_versiones]   ordenadas por id
+//   LibroPaquete[num_libros]        por versión, ordenados por número de libro
+//   CapituloPaquete[num_capitulos]  por libro, el capítulo c está en primer_capitulo + c - 1
+//   VersoPaquete[num_versos]        por capítulo, en orden de versículo
+//   texto UTF-8                     nombres de libros y versículos, uno tras otro sin separador
+// La cabecera guarda tamaño y fecha de modificación de biblias.db: si no coinciden, el paquete
+// está desactualizado y se vuelve a leer de SQLite.
+
+namespace paquete_biblia {
+
+constexpr char MAGIA[8] = { 'E', 'P', 'B', 'I', 'B', 'L', 'I', 'A' };
+constexpr uint32_t VERSION_FORMATO = 1;
+
+struct CabeceraPaquete {
+    char magia[8]; uint32_t version_formato; uint32_t num_versiones;
+    uint64_t fuente_tamano; int64_t fuente_mtime;
+    uint64_t off_versiones, off_libros, off_capitulos, off_versos, off_texto, tam_texto;
+    uint32_t num_libros, num_capitulos, num_versos, reservado;
+};
+struct VersionPaquete { int32_t id; uint32_t primer_libro; uint32_t num_libros; uint32_t reservado; };
+struct LibroPaquete { int32_t numero; uint32_t nombre_off; uint32_t nombre_len; uint32_t primer_capitulo; uint32_t num_capitulos; };
+struct CapituloPaquete { uint32_t primer_verso; uint32_t num_versos; };
+struct VersoPaquete { int32_t numero; uint32_t texto_off; uint32_t texto_len; };
+
+// Huella de biblias.db para detectar un paquete desactualizado
+inline bool huella_fuente(const std::filesystem::path& ruta, uint64_t& tamano, int64_t& mtime) {
+    std::error_code ec;
+    tamano = std::filesystem::file_size(ruta, ec); if (ec) return false;
+    auto t = std::filesystem::last_write_time(ruta, ec); if (ec) return false;
+    mtime = static_cast<int64_t>(t.time_since_epoch().count()); return true;
+}
+
+inline uint64_t alinear8(uint64_t x) { return (x + 7) & ~uint64_t(7); }
+
+// Lee biblias.db completo y escribe el paquete. Devuelve false y deja `error` si algo falla.
+inline bool empaquetar(const std::filesystem::path& ruta_db, const std::filesystem::path& ruta_paquete, std::string& error) {
+    uint64_t fuente_tamano; int64_t fuente_mtime;
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(ruta_db.string().c_str(), &db, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK) { error = "no se pudo abrir " + ruta_db.string(); sqlite3_close(db); return false; }
+    // La app abre la base en modo WAL; si la conversión ocurriera después, cambiaría la fecha
+    // del archivo y el paquete recién generado parecería desactualizado.
+    sqlite3_exec(db, "PRAGMA journal_mode = WAL", nullptr, nullptr, nullptr);
+
+    std::vector<VersionPaquete> versiones; std::vector<LibroPaquete> libros; std::vector<CapituloPaquete> capitulos; std::vector<VersoPaquete> versos; std::string texto;
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "SELECT version_id, libro_numero, libro_nombre, capitulo, versiculo, texto FROM versiculos ORDER BY version_id, libro_numero, capitulo, versiculo";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) { error = sqlite3_errmsg(db); sqlite3_close(db); return false; }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int v_id = sqlite3_column_int(stmt, 0), libro = sqlite3_column_int(stmt, 1), cap = sqlite3_column_int(stmt, 3), num = sqlite3_column_int(stmt, 4);
+        if (cap < 1) continue;
+        if (versiones.empty() || versiones.back().id != v_id) versiones.push_back({ v_id, static_cast<uint32_t>(libros.size()), 0, 0 });
+        auto& version = versiones.back();
+        if (version.num_libros == 0 || libros.back().numero != libro) {
+            const char* nombre = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)); std::string_view n = nombre ? nombre : "";
+            libros.push_back({ libro, static_cast<uint32_t>(texto.size()), static_cast<uint32_t>(n.size()), static_cast<uint32_t>(capitulos.size()), 0 });
+            texto.append(n); version.num_libros++;
+        }
+        auto& lib = libros.back();
+        // Capítulos faltantes quedan como capítulos vacíos para mantener el acceso directo por número
+        while (lib.num_capitulos < static_cast<uint32_t>(cap)) { capitulos.push_back({ static_cast<uint32_t>(versos.size()), 0 }); lib.num_capitulos++; }
+        auto& capitulo = capitulos[lib.primer_capitulo + cap - 1];
+        const char* t = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5)); int len = sqlite3_column_bytes(stmt, 5);
+        versos.push_back({ num, static_cast<uint32_t>(texto.size()), static_cast<uint32_t>(len) });
+        if (t) texto.append(t, len);
+        capitulo.num_versos++;
+    }
+    sqlite3_finalize(stmt); sqlite3_close(db);
+    if (versos.empty()) { error = "biblias.db no tiene versículos"; return false; }
+    if (texto.size() > UINT32_MAX) { error = "el texto supera 4 GB"; return false; }
+    if (!huella_fuente(ruta_db, fuente_tamano, fuente_mtime)) { error = "no se pudo leer la fecha de " + ruta_db.string(); return false; }
+
+    CabeceraPaquete cab{};
+    std::memcpy(cab.magia, MAGIA, sizeof(MAGIA)); cab.version_formato = VERSION_FORMATO;
+    cab.num_versiones = static_cast<uint32_t>(versiones.size()); cab.num_libros = static_cast<uint32_t>(libros.size());
+    cab.num_capitulos = static_cast<uint32_t>(capitulos.size()); cab.num_versos = static_cast<uint32_t>(versos.size());
+    cab.fuente_tamano = fuente_tamano; cab.fuente_mtime = fuente_mtime;
+    cab.off_versiones = alinear8(sizeof(CabeceraPaquete));
+    cab.off_libros = alinear8(cab.off_versiones + versiones.size() * sizeof(VersionPaquete));
+    cab.off_capitulos = alinear8(cab.off_libros + libros.size() * sizeof(LibroPaquete));
+    cab.off_versos = alinear8(cab.off_capitulos + capitulos.size() * sizeof(CapituloPaquete));
+    cab.off_texto = alinear8(cab.off_versos + versos.size() * sizeof(VersoPaquete));
+    cab.tam_texto = texto.size();
+
+    // Se escribe a un temporal y se renombra, así nunca queda un paquete a medias con nombre válido
+    auto temporal = ruta_paquete; temporal += ".tmp";
+    {
+        std::ofstream out(temporal, std::ios::binary | std::ios::trunc);
+        if (!out) { error = "no se pudo escribir " + temporal.string(); return false; }
+        auto escribir = [&out](uint64_t offset, const void* datos, size_t bytes) {
+            uint64_t pos = static_cast<uint64_t>(out.tellp());
+            static const char ceros[8] = {}; if (offset > pos) out.write(ceros, static_cast<std::streamsize>(offset - pos));
+            out.write(static_cast<const char*>(datos), static_cast<std::streamsize>(bytes));
+        };
+        escribir(0, &cab, sizeof(cab));
+        escribir(cab.off_versiones, versiones.data(), versiones.size() * sizeof(VersionPaquete));
+        escribir(cab.off_libros, libros.data(), libros.size() * sizeof(LibroPaquete));
+        escribir(cab.off_capitulos, capitulos.data(), capitulos.size() * sizeof(CapituloPaquete));
+        escribir(cab.off_versos, versos.data(), versos.size() * sizeof(VersoPaquete));
+        escribir(cab.off_texto, texto.data(), texto.size());
+        if (!out) { error = "error al escribir " + temporal.string(); return false; }
+    }
+    std::error_code ec; std::filesystem::rename(temporal, ruta_paquete, ec);
+    if (ec) { error = "no se pudo renombrar " + temporal.string() + ": " + ec.message(); return false; }
+    return true;
+}
+
+// Vista de un capítulo dentro del paquete. Los string_view apuntan al archivo mapeado
+// y son válidos mientras el PaqueteBiblia siga abierto; los offsets ya se validaron al abrirlo.
+class CapituloVista {
+private:
+    const VersoPaquete* versos = nullptr; size_t n = 0; const char* texto = nullptr;
+
+public:
+    struct Verso { int numero; std::string_view texto; };
+    CapituloVista() = default;
+    CapituloVista(const VersoPaquete* v, size_t cantidad, const char* t) : versos(v), n(cantidad), texto(t) {}
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    Verso operator[](size_t i) const { return { versos[i].numero, std::string_view(texto + versos[i].texto_off, versos[i].texto_len) }; }
+};
+
+class PaqueteBiblia {
+private:
+    const char* base = nullptr; size_t tamano = 0;
+    const CabeceraPaquete* cab = nullptr;
+#ifdef _WIN32
+    HANDLE archivo = INVALID_HANDLE_VALUE; HANDLE mapeo = nullptr;
+#endif
+
+    template <typename T> const T* seccion(uint64_t offset) const { return reinterpret_cast<const T*>(base + offset); }
+
+    const LibroPaquete* buscar_libro(int version_id, int libro_numero) const {
+        if (!cab) return nullptr;
+        const auto* versiones = seccion<VersionPaquete>(cab->off_versiones);
+        const auto* fin_v = versiones + cab->num_versiones;
+        const auto* v = std::lower_bound(versiones, fin_v, version_id, [](const VersionPaquete& a, int id) { return a.id < id; });
+        if (v == fin_v || v->id != version_id) return nullptr;
+        const auto* libros = seccion<LibroPaquete>(cab->off_libros) + v->primer_libro;
+        const auto* fin_l = libros + v->num_libros;
+        const auto* l = std::lower_bound(libros, fin_l, libro_numero, [](const LibroPaquete& a, int n) { return a.numero < n; });
+        return (l == fin_l || l->numero != libro_numero) ? nullptr : l;
+    }
+
+    // Comprueba, una sola vez al abrir, que las secciones caben en el archivo y que cada índice y cada
+    // offset de texto cae dentro de su sección: un paquete truncado o dañado no se usa y se lee de SQLite.
+    // Después de esto CapituloVista puede leer sin más comprobaciones.
+    bool validar(uint64_t fuente_tamano, int64_t fuente_mtime) const {
+        if (tamano < sizeof(CabeceraPaquete)) return false;
+        const auto* c = reinterpret_cast<const CabeceraPaquete*>(base);
+        if (std::memcmp(c->magia, MAGIA, sizeof(MAGIA)) != 0 || c->version_formato != VERSION_FORMATO) return false;
+        if (c->fuente_tamano != fuente_tamano || c->fuente_mtime != fuente_mtime) return false;
+        auto cabe = [this](uint64_t off, uint64_t bytes) { return off % 8 == 0 && off <= tamano && bytes <= tamano - off; };
+        if (!(cabe(c->off_versiones, uint64_t(c->num_versiones) * sizeof(VersionPaquete)) && cabe(c->off_libros, uint64_t(c->num_libros) * sizeof(LibroPaquete))
+            && cabe(c->off_capitulos, uint64_t(c->num_capitulos) * sizeof(CapituloPaquete)) && cabe(c->off_versos, uint64_t(c->num_versos) * sizeof(VersoPaquete))
+            && cabe(c->off_texto, c->tam_texto))) return false;
+        auto en_texto = [c](uint32_t off, uint32_t len) { return uint64_t(off) + len <= c->tam_texto; };
+        const auto* versiones = reinterpret_cast<const VersionPaquete*>(base + c->off_versiones);
+        for (uint32_t v = 0; v < c->num_versiones; ++v)
+            if (uint64_t(versiones[v].primer_libro) + versiones[v].num_libros > c->num_libros) return false;
+        const auto* libros = reinterpret_cast<const LibroPaquete*>(base + c->off_libros);
+        for (uint32_t l = 0; l < c->num_libros; ++l)
+            if (uint64_t(libros[l].primer_capitulo) + libros[l].num_capitulos > c->num_capitulos || !en_texto(libros[l].nombre_off, libros[l].nombre_len)) return false;
+        const auto* capitulos = reinterpret_cast<const CapituloPaquete*>(base + c->off_capitulos);
+        for (uint32_t i = 0; i < c->num_capitulos; ++i)
+            if (uint64_t(capitulos[i].primer_verso) + capitulos[i].num_versos > c->num_versos) return false;
+        const auto* versos = reinterpret_cast<const VersoPaquete*>(base + c->off_versos);
+        for (uint32_t i = 0; i < c->num_versos; ++i)
+            if (!en_texto(versos[i].texto_off, versos[i].texto_len)) return false;
+        return true;
+    }
+
+public:
+    PaqueteBiblia() = default;
+    PaqueteBiblia(const PaqueteBiblia&) = delete;
+    PaqueteBiblia& operator=(const PaqueteBiblia&) = delete;
+    ~PaqueteBiblia() { cerrar(); }
+
+    // Mapea el paquete si existe y corresponde a la versión actual de biblias.db
+    bool abrir(const std::filesystem::path& ruta_paquete, const std::filesystem::path& ruta_db) {
+        cerrar();
+        uint64_t fuente_tamano; int64_t fuente_mtime;
+        std::error_code ec;
+        if (!std::filesystem::exists(ruta_paquete, ec) || !huella_fuente(ruta_db, fuente_tamano, fuente_mtime)) return false;
+#ifdef _WIN32
+        archivo = CreateFileW(ruta_paquete.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (archivo == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER tam; if (!GetFileSizeEx(archivo, &tam) || tam.QuadPart == 0) { cerrar(); return false; }
+        mapeo = CreateFileMappingW(archivo, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapeo) { cerrar(); return false; }
+        base = static_cast<const char*>(MapViewOfFile(mapeo, FILE_MAP_READ, 0, 0, 0));
+        if (!base) { cerrar(); return false; }
+        tamano = static_cast<size_t>(tam.QuadPart);
+#else
+        int fd = ::open(ruta_paquete.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st; if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base = static_cast<const char*>(p); tamano = static_cast<size_t>(st.st_size);
+#endif
+        if (!validar(fuente_tamano, fuente_mtime)) { cerrar(); return false; }
+        cab = reinterpret_cast<const CabeceraPaquete*>(base);
+        return true;
+    }
+
+    void cerrar() {
+        cab = nullptr;
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapeo) CloseHandle(mapeo);
+        if (archivo != INVALID_HANDLE_VALUE) CloseHandle(archivo);
+        mapeo = nullptr; archivo = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap(const_cast<char*>(base), tamano);
+#endif
+        base = nullptr; tamano = 0;
+    }
+
+    bool abierto() const { return cab != nullptr; }
+
+    // Recorre los libros de todas las versiones sin leer versículos:
+    // visitar(version_id, libro_numero, nombre, versos_por_capitulo)
+    template <typename Visitar> void recorrer_libros(Visitar&& visitar) const {
+        if (!cab) return;
+        const auto* versiones = seccion<VersionPaquete>(cab->off_versiones);
+        const auto* libros = seccion<LibroPaquete>(cab->off_libros);
+        const auto* capitulos = seccion<CapituloPaquete>(cab->off_capitulos);
+        const char* texto = seccion<char>(cab->off_texto);
+        std::vector<int> versos;
+        for (uint32_t v = 0; v < cab->num_versiones; ++v) {
+            for (uint32_t i = 0; i < versiones[v].num_libros; ++i) {
+                const auto& l = libros[versiones[v].primer_libro + i];
+                versos.clear();
+                for (uint32_t c = 0; c < l.num_capitulos; ++c) versos.push_back(static_cast<int>(capitulos[l.primer_capitulo + c].num_versos));
+                visitar(versiones[v].id, l.numero, std::string_view(texto + l.nombre_off, l.nombre_len), versos);
+            }
+        }
+    }
+
+    CapituloVista capitulo(int version_id, int libro_numero, int capitulo) const {
+        const auto* libro = buscar_libro(version_id, libro_numero);
+        if (!libro || capitulo < 1 || static_cast<uint32_t>(capitulo) > libro->num_capitulos) return {};
+        const auto& c = seccion<CapituloPaquete>(cab->off_capitulos)[libro->primer_capitulo + capitulo - 1];
+        return { seccion<VersoPaquete>(cab->off_versos) + c.primer_verso, c.num_versos, seccion<char>(cab->off_texto) };
+    }
+};
+
+} // namespace paquete_biblia
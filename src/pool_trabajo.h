@@ -0,0 +1,70 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool fijo de hilos con dos colas. Los trabajos de primer plano (lo que el operador pidió)
+// siempre se toman antes que los de segundo plano (precargas). Al detenerse se descartan
+// los trabajos pendientes y se espera (join) a los que están en curso.
+class PoolTrabajo {
+public:
+    enum class Prioridad { PrimerPlano, SegundoPlano };
+
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> cola_primer_plano;
+    std::deque<std::function<void()>> cola_segundo_plano;
+    std::vector<std::thread> hilos;
+    bool detenido = false;
+
+    std::deque<std::function<void()>>& cola_de(Prioridad p) { return p == Prioridad::PrimerPlano ? cola_primer_plano : cola_segundo_plano; }
+
+    void bucle() {
+        while (true) {
+            std::function<void()> trabajo;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return detenido || !cola_primer_plano.empty() || !cola_segundo_plano.empty(); });
+                if (detenido) return;
+                auto& cola = !cola_primer_plano.empty() ? cola_primer_plano : cola_segundo_plano;
+                trabajo = std::move(cola.front()); cola.pop_front();
+            }
+            trabajo();
+        }
+    }
+
+public:
+    explicit PoolTrabajo(size_t num_hilos = 2) {
+        for (size_t i = 0; i < num_hilos; ++i) hilos.emplace_back([this] { bucle(); });
+    }
+    PoolTrabajo(const PoolTrabajo&) = delete;
+    PoolTrabajo& operator=(const PoolTrabajo&) = delete;
+    ~PoolTrabajo() { detener(); }
+
+    void encolar(std::function<void()> trabajo, Prioridad prioridad = Prioridad::PrimerPlano) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (detenido) return;
+            cola_de(prioridad).push_back(std::move(trabajo));
+        }
+        cv.notify_one();
+    }
+
+    // Descarta lo que aún no empezó en esa cola (p. ej. precargas que ya no sirven)
+    void descartar_pendientes(Prioridad prioridad) { std::lock_guard<std::mutex> lock(mtx); cola_de(prioridad).clear(); }
+    size_t pendientes(Prioridad prioridad) { std::lock_guard<std::mutex> lock(mtx); return cola_de(prioridad).size(); }
+
+    void detener() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (detenido) return;
+            detenido = true; cola_primer_plano.clear(); cola_segundo_plano.clear();
+        }
+        cv.notify_all();
+        for (auto& h : hilos) if (h.joinable()) h.join();
+    }
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <string_view>
+
+// Referencia bíblica tal como la escribe el operador. `libro` apunta al texto original (sin copiar)
+// y queda vacío cuando la referencia encadenada hereda el libro anterior ("Jn 3:16; 4:8").
+// Sin versículo, verso_inicio = verso_fin = 0 (capítulo completo).
+struct ReferenciaBiblica { std::string_view libro; int capitulo = 0; int verso_inicio = 0; int verso_fin = 0; };
+
+namespace referencia {
+
+inline bool es_espacio(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+inline bool es_digito(char c) { return c >= '0' && c <= '9'; }
+
+inline std::string_view recortar(std::string_view s) {
+    while (!s.empty() && es_espacio(s.front())) s.remove_prefix(1);
+    while (!s.empty() && es_espacio(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+// Lee un número de hasta 3 cifras (ningún capítulo ni versículo pasa de 176); 0 si no hay número
+inline int leer_numero(std::string_view s, size_t& pos) {
+    int n = 0; size_t inicio = pos;
+    while (pos < s.size() && es_digito(s[pos])) {
+        if (pos - inicio == 3) return 0;
+        n = n * 10 + (s[pos++] - '0');
+    } return n;
+}
+
+inline void saltar_espacios(std::string_view s, size_t& pos) { while (pos < s.size() && es_espacio(s[pos])) ++pos; }
+
+// Guion, o raya/guion largo en UTF-8 (U+2013, U+2014)
+inline bool leer_guion(std::string_view s, size_t& pos) {
+    if (pos < s.size() && s[pos] == '-') { ++pos; return true; }
+    if (s.substr(pos, 3) == "\xE2\x80\x93" || s.substr(pos, 3) == "\xE2\x80\x94") { pos += 3; return true; }
+    return false;
+}
+
+// Una sola referencia, sin ';'. Acepta "Jn 3:16", "Juan 3 16", "1 Co 13:4-7", "Sal 23, 1-3", "Sal 23.1",
+// "Jn3:16", "Rut 2" y, sin libro, "4:8". El libro es todo lo que precede al número de capítulo;
+// un número inicial seguido de letras forma parte del libro ("1 Co", "2Tim").
+inline bool parsear_una(std::string_view texto, ReferenciaBiblica& ref) {
+    std::string_view s = recortar(texto);
+    ref = ReferenciaBiblica{};
+    size_t pos = 0;
+    // Número ordinal del libro ("1", "2", "3") solo si después vienen letras
+    if (pos < s.size() && es_digito(s[pos])) {
+        size_t p = pos; while (p < s.size() && es_digito(s[p])) ++p;
+        size_t q = p; saltar_espacios(s, q);
+        if (p - pos == 1 && q < s.size() && !es_digito(s[q]) && s[q] != ':' && s[q] != ',' && s[q] != '.' && s[q] != '-' && (static_cast<unsigned char>(s[q]) >= 0x80 || ((s[q] | 0x20) >= 'a' && (s[q] | 0x20) <= 'z'))) pos = q;
+    }
+    // Nombre del libro: hasta el primer dígito
+    size_t fin_libro = pos;
+    while (fin_libro < s.size() && !es_digito(s[fin_libro])) ++fin_libro;
+    if (fin_libro == s.size()) return false;
+    ref.libro = recortar(s.substr(0, fin_libro));
+    if (!ref.libro.empty() && ref.libro.back() == '.') { ref.libro.remove_suffix(1); ref.libro = recortar(ref.libro); }
+    pos = fin_libro;
+
+    ref.capitulo = leer_numero(s, pos);
+    if (ref.capitulo == 0) return false;
+    saltar_espacios(s, pos);
+    if (pos == s.size()) return true;
+
+    if (s[pos] == ':' || s[pos] == ',' || s[pos] == '.') { ++pos; saltar_espacios(s, pos); }
+    ref.verso_inicio = leer_numero(s, pos);
+    if (ref.verso_inicio == 0) return false;
+    ref.verso_fin = ref.verso_inicio;
+    saltar_espacios(s, pos);
+    if (leer_guion(s, pos)) {
+        saltar_espacios(s, pos);
+        ref.verso_fin = leer_numero(s, pos);
+        if (ref.verso_fin < ref.verso_inicio) return false;
+        saltar_espacios(s, pos);
+    }
+    return pos == s.size();
+}
+
+} // namespace referencia
+
+// Lee la siguiente referencia de una cadena separada por ';' y avanza `texto` tras ella.
+// Devuelve false cuando ya no quedan referencias o la siguiente no se entiende (en ese caso
+// `texto` queda apuntando a ella). Los tramos vacíos ("Jn 3:16;;") se saltan. No reserva memoria.
+inline bool leer_referencia(std::string_view& texto, ReferenciaBiblica& ref) {
+    while (true) {
+        if (referencia::recortar(texto).empty()) return false;
+        size_t fin = texto.find(';');
+        std::string_view tramo = texto.substr(0, fin);
+        if (referencia::recortar(tramo).empty()) { texto.remove_prefix(fin + 1); continue; }
+        if (!referencia::parsear_una(tramo, ref)) return false;
+        texto.remove_prefix(fin == std::string_view::npos ? texto.size() : fin + 1);
+        return true;
+    }
+}
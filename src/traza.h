@@ -0,0 +1,179 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Trazas de latencia del camino operador -> proyector. Se activan con EASYPRESENTER_TRAZA:
+//   EASYPRESENTER_TRAZA=1               solo el resumen por etapa al cerrar
+//   EASYPRESENTER_TRAZA=servicio.json   además, todos los eventos en formato Chrome trace (chrome://tracing, Perfetto)
+//   EASYPRESENTER_TRAZA=servicio.csv    además, todos los eventos en CSV
+// Desactivadas, cada punto de medición cuesta una lectura de un bool: no se lee el reloj ni se toma ningún lock.
+namespace traza {
+
+enum class Etapa { Entrada, Consulta, Cache, Modelo, Salto, Ajuste, Proyeccion, Frame, Cantidad };
+
+inline const char* nombre_etapa(Etapa e) {
+    static constexpr const char* NOMBRES[] = { "entrada", "consulta", "cache", "modelo", "salto", "ajuste", "proyeccion", "frame" };
+    return NOMBRES[static_cast<size_t>(e)];
+}
+
+inline const char* destino() { static const char* d = std::getenv("EASYPRESENTER_TRAZA"); return d; }
+inline const bool ACTIVA = destino() && *destino() && std::string(destino()) != "0";
+inline bool activa() { return ACTIVA; }
+
+// Nanosegundos desde la primera medición (nunca 0: 0 significa "sin marca")
+inline uint64_t ahora() {
+    static const auto origen = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origen).count()) + 1;
+}
+
+// Marca de tiempo para medir un tramo que empieza en un hilo y termina en otro (p. ej. antes de
+// invoke_from_event_loop y dentro del callback); 0 si las trazas están desactivadas
+inline uint64_t marca() { return ACTIVA ? ahora() : 0; }
+
+// Histograma por potencias de 2 de microsegundos: el cubo k cuenta duraciones en [2^(k-1), 2^k) µs
+struct Histograma {
+    static constexpr size_t CUBOS = 32;
+    std::array<uint64_t, CUBOS> cubos{}; uint64_t cantidad = 0; uint64_t total_ns = 0; uint64_t maximo_ns = 0;
+
+    void agregar(uint64_t ns) {
+        uint64_t us = ns / 1000; size_t k = 0;
+        while (us && k + 1 < CUBOS) { us >>= 1; ++k; }
+        cubos[k]++; cantidad++; total_ns += ns; maximo_ns = std::max(maximo_ns, ns);
+    }
+    // Cota superior del percentil q (0..1) en µs
+    double percentil_us(double q) const {
+        uint64_t objetivo = static_cast<uint64_t>(q * static_cast<double>(cantidad) + 0.5), acumulado = 0;
+        for (size_t k = 0; k < CUBOS; ++k) { acumulado += cubos[k]; if (acumulado >= std::max<uint64_t>(objetivo, 1)) return static_cast<double>(1ULL << k); }
+        return static_cast<double>(maximo_ns) / 1000.0;
+    }
+};
+
+class Registro {
+public:
+    struct Evento { const char* nombre; Etapa etapa; uint32_t hilo; uint64_t inicio_ns; uint64_t duracion_ns; };
+
+private:
+    // Tope de eventos guardados (~32 MB); los histogramas siguen contando aunque se llegue
+    static constexpr size_t MAX_EVENTOS = 1 << 20;
+    std::mutex mtx;
+    std::vector<Evento> eventos;
+    std::array<Histograma, static_cast<size_t>(Etapa::Cantidad)> histogramas;
+    std::vector<std::pair<uint32_t, std::string>> nombres_hilos;
+    uint64_t descartados = 0;
+    std::atomic<uint32_t> siguiente_hilo{1};
+    std::atomic<uint64_t> ultima_entrada{0};
+
+    static std::string escapar_json(const std::string& s) {
+        std::string r;
+        for (char c : s) { if (c == '"' || c == '\\') r += '\\'; r += c; }
+        return r;
+    }
+
+public:
+    static Registro& global() { static Registro r; return r; }
+
+    uint32_t hilo_actual() { thread_local uint32_t id = siguiente_hilo++; return id; }
+
+    void nombrar_hilo(const char* nombre) {
+        if (!ACTIVA) return;
+        uint32_t id = hilo_actual(); std::lock_guard<std::mutex> lock(mtx);
+        nombres_hilos.emplace_back(id, nombre);
+    }
+
+    void registrar(Etapa etapa, const char* nombre, uint64_t inicio_ns, uint64_t fin_ns) {
+        uint32_t hilo = hilo_actual(); uint64_t duracion = fin_ns > inicio_ns ? fin_ns - inicio_ns : 0;
+        std::lock_guard<std::mutex> lock(mtx);
+        histogramas[static_cast<size_t>(etapa)].agregar(duracion);
+        if (eventos.size() < MAX_EVENTOS) eventos.push_back({ nombre, etapa, hilo, inicio_ns, duracion }); else descartados++;
+    }
+
+    // Acción del operador (clic, tecla): desde aquí se mide hasta el siguiente cuadro del proyector.
+    // Si ya hay una acción esperando su cuadro (p. ej. el Enter que abrió un capítulo y ahora lo
+    // proyecta), se conserva la primera; una acción que en 2 s no llegó al proyector se descarta.
+    void entrada() {
+        uint64_t t = ahora(), pendiente = ultima_entrada.load();
+        while ((pendiente == 0 || t - pendiente > 2'000'000'000ULL) && !ultima_entrada.compare_exchange_weak(pendiente, t)) {}
+    }
+    // Se llama después de que el proyector dibuja un cuadro. Registra "entrada -> frame" una sola
+    // vez por acción: los cuadros siguientes sin una acción nueva no cuentan.
+    void frame_dibujado() {
+        uint64_t inicio = ultima_entrada.exchange(0);
+        if (inicio) registrar(Etapa::Frame, "entrada -> frame", inicio, ahora());
+    }
+
+    // Resumen por etapa en la consola y, según EASYPRESENTER_TRAZA, el volcado de eventos
+    void exportar() {
+        if (!ACTIVA) return;
+        std::lock_guard<std::mutex> lock(mtx);
+        std::cout << "[Traza] Etapa        eventos      p50 µs      p99 µs      máx µs    media µs" << std::endl;
+        for (size_t e = 0; e < histogramas.size(); ++e) {
+            const auto& h = histogramas[e]; if (!h.cantidad) continue;
+            char linea[160];
+            std::snprintf(linea, sizeof(linea), "[Traza] %-11s %8llu %11.0f %11.0f %11.1f %11.1f", nombre_etapa(static_cast<Etapa>(e)), static_cast<unsigned long long>(h.cantidad),
+                          h.percentil_us(0.50), h.percentil_us(0.99), h.maximo_ns / 1000.0, h.total_ns / 1000.0 / h.cantidad);
+            std::cout << linea << std::endl;
+        }
+        if (descartados) std::cout << "[Traza] " << descartados << " eventos no se guardaron (tope de " << MAX_EVENTOS << ")" << std::endl;
+
+        std::string ruta = destino();
+        bool csv = ruta.size() > 4 && ruta.compare(ruta.size() - 4, 4, ".csv") == 0;
+        bool json = ruta.size() > 5 && ruta.compare(ruta.size() - 5, 5, ".json") == 0;
+        if (!csv && !json) return;
+        std::ofstream f(ruta);
+        if (!f) { std::cerr << "[Traza] No se pudo escribir " << ruta << std::endl; return; }
+        if (csv) {
+            f << "etapa,nombre,hilo,inicio_us,duracion_us\n";
+            char num[64];
+            for (const auto& ev : eventos) {
+                std::snprintf(num, sizeof(num), "%.3f,%.3f", ev.inicio_ns / 1000.0, ev.duracion_ns / 1000.0);
+                f << nombre_etapa(ev.etapa) << ",\"" << ev.nombre << "\"," << ev.hilo << "," << num << "\n";
+            }
+        } else {
+            // Eventos completos ("ph":"X") con tiempos en µs, más el nombre de cada hilo
+            f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+            bool primero = true;
+            for (const auto& [id, nombre] : nombres_hilos) {
+                f << (primero ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << id << ",\"args\":{\"name\":\"" << escapar_json(nombre) << "\"}}";
+                primero = false;
+            }
+            char num[64];
+            for (const auto& ev : eventos) {
+                std::snprintf(num, sizeof(num), "\"ts\":%.3f,\"dur\":%.3f", ev.inicio_ns / 1000.0, ev.duracion_ns / 1000.0);
+                f << (primero ? "" : ",\n") << "{\"name\":\"" << escapar_json(ev.nombre) << "\",\"cat\":\"" << nombre_etapa(ev.etapa) << "\",\"ph\":\"X\"," << num << ",\"pid\":1,\"tid\":" << ev.hilo << "}";
+                primero = false;
+            }
+            f << "\n]}\n";
+        }
+        std::cout << "[Traza] " << eventos.size() << " eventos en " << ruta << std::endl;
+    }
+};
+
+// Tramo que empieza en `inicio` (de marca()) y termina ahora
+inline void registrar_desde(Etapa etapa, const char* nombre, uint64_t inicio) { if (ACTIVA && inicio) Registro::global().registrar(etapa, nombre, inicio, ahora()); }
+
+// Marca el comienzo de una acción del operador (ver Registro::frame_dibujado)
+inline void entrada() { if (ACTIVA) Registro::global().entrada(); }
+
+// Mide el alcance donde se declara. `nombre` debe ser un literal (no se copia).
+class Medicion {
+private:
+    Etapa etapa; const char* nombre; uint64_t inicio;
+
+public:
+    Medicion(Etapa e, const char* n) : etapa(e), nombre(n), inicio(ACTIVA ? ahora() : 0) {}
+    Medicion(const Medicion&) = delete;
+    Medicion& operator=(const Medicion&) = delete;
+    ~Medicion() { if (inicio) Registro::global().registrar(etapa, nombre, inicio, ahora()); }
+};
+
+} // namespace traza
@@ -0,0 +1,199 @@
+// bench_conexiones: carga mixta de lectura y escritura sobre una base de cantos temporal.
+// Compara la conexión única detrás de un mutex global (lo que había) con el pool de lectores
+// de solo lectura más una conexión de escritura, y reporta p50/p99/máx de cada operación.
+//
+//   bench_conexiones [lectores] [segundos por modo] [cantos por escritura] [cantos iniciales]
+#include "conexiones_sqlite.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Reloj = std::chrono::steady_clock;
+
+// Vocabulario sintético de sílabas: unas 4000 palabras, así las búsquedas son tan selectivas como en un cancionero real
+static const std::vector<std::string>& vocabulario() {
+    static const std::vector<std::string> palabras = [] {
+        static const char* SILABAS[] = { "ma", "ra", "sal", "glo", "ri", "a", "se", "ñor", "cie", "lo", "san", "to", "gra", "cia", "vi", "da",
+                                         "cruz", "luz", "re", "y", "pa", "z", "go", "zo", "no", "bre", "fi", "el", "es", "pí", "tu", "can" };
+        std::vector<std::string> v; std::mt19937 rng(3);
+        for (int i = 0; i < 4000; ++i) { std::string w; for (int s = 2 + rng() % 2; s > 0; --s) w += SILABAS[rng() % std::size(SILABAS)]; v.push_back(w); }
+        return v;
+    }();
+    return palabras;
+}
+
+static std::string frase(std::mt19937& rng, int palabras) {
+    const auto& v = vocabulario(); std::string s;
+    for (int i = 0; i < palabras; ++i) { if (i) s += ' '; s += v[rng() % v.size()]; }
+    return s;
+}
+
+// Mismo esquema que cantos.db tras preparar_indice_fts
+static void crear_base(const std::string& ruta, int cantos) {
+    std::remove(ruta.c_str()); std::remove((ruta + "-wal").c_str()); std::remove((ruta + "-shm").c_str());
+    sqlite3* db = nullptr; sqlite3_open(ruta.c_str(), &db);
+    sqlite3_exec(db, "PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;"
+        "CREATE TABLE cantos (id INTEGER PRIMARY KEY AUTOINCREMENT, titulo TEXT, tono TEXT, categoria TEXT);"
+        "CREATE TABLE diapositivas (id INTEGER PRIMARY KEY AUTOINCREMENT, canto_id INTEGER, orden INTEGER, texto TEXT);"
+        "CREATE INDEX idx_diapositivas_canto ON diapositivas(canto_id, orden);"
+        "CREATE VIRTUAL TABLE cantos_fts USING fts5(titulo, texto, canto_id UNINDEXED, orden UNINDEXED, tokenize = 'unicode61 remove_diacritics 2', prefix = '1 2 3');",
+        nullptr, nullptr, nullptr);
+    std::mt19937 rng(1);
+    sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+    for (int c = 1; c <= cantos; ++c) {
+        std::string titulo = frase(rng, 3), sql = "INSERT INTO cantos (id, titulo, tono, categoria) VALUES (" + std::to_string(c) + ", '" + titulo + "', '', 'Cantos');"
+            "INSERT INTO cantos_fts (rowid, titulo, texto, canto_id, orden) VALUES (" + std::to_string(-c) + ", '" + titulo + "', '', " + std::to_string(c) + ", 0);";
+        for (int o = 1; o <= 6; ++o) {
+            std::string texto = frase(rng, 24);
+            sql += "INSERT INTO diapositivas (canto_id, orden, texto) VALUES (" + std::to_string(c) + ", " + std::to_string(o) + ", '" + texto + "');"
+                   "INSERT INTO cantos_fts (rowid, titulo, texto, canto_id, orden) VALUES (last_insert_rowid(), '', '" + texto + "', " + std::to_string(c) + ", " + std::to_string(o) + ");";
+        }
+        sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
+    }
+    sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+}
+
+// Lectura típica de la interfaz: búsqueda por prefijo y luego las diapositivas del primer resultado
+static bool leer(CacheSentencias& sql, const std::string& consulta) {
+    int canto = 0;
+    {
+        SentenciaUso stmt(sql, "SELECT canto_id FROM cantos_fts WHERE cantos_fts MATCH ? ORDER BY rank LIMIT 50");
+        if (!stmt) return false;
+        sqlite3_bind_text(stmt, 1, consulta.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) if (!canto) canto = sqlite3_column_int(stmt, 0);
+    }
+    SentenciaUso stmt(sql, "SELECT texto FROM diapositivas WHERE canto_id = ? ORDER BY orden");
+    sqlite3_bind_int(stmt, 1, canto);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {}
+    return true;
+}
+
+// Un canto con sus diapositivas, dentro de la transacción abierta por escribir()
+static bool escribir_canto(sqlite3* db, CacheSentencias& sql, std::mt19937& rng) {
+    std::string titulo = frase(rng, 3);
+    {
+        SentenciaUso stmt(sql, "INSERT INTO cantos (titulo, tono, categoria) VALUES (?, '', 'Cantos')");
+        sqlite3_bind_text(stmt, 1, titulo.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+    }
+    sqlite3_int64 canto = sqlite3_last_insert_rowid(db);
+    {
+        SentenciaUso stmt(sql, "INSERT INTO cantos_fts (rowid, titulo, texto, canto_id, orden) VALUES (?, ?, '', ?, 0)");
+        sqlite3_bind_int64(stmt, 1, -canto); sqlite3_bind_text(stmt, 2, titulo.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int64(stmt, 3, canto);
+        sqlite3_step(stmt);
+    }
+    for (int o = 1; o <= 6; ++o) {
+        std::string texto = frase(rng, 24);
+        SentenciaUso stmt(sql, "INSERT INTO diapositivas (canto_id, orden, texto) VALUES (?, ?, ?)");
+        sqlite3_bind_int64(stmt, 1, canto); sqlite3_bind_int(stmt, 2, o); sqlite3_bind_text(stmt, 3, texto.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt);
+        SentenciaUso fts(sql, "INSERT INTO cantos_fts (rowid, titulo, texto, canto_id, orden) VALUES (?, '', ?, ?, ?)");
+        sqlite3_bind_int64(fts, 1, sqlite3_last_insert_rowid(db)); sqlite3_bind_text(fts, 2, texto.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(fts, 3, canto); sqlite3_bind_int(fts, 4, o);
+        sqlite3_step(fts);
+    }
+    return true;
+}
+
+// Escritura típica: guardar `cantos` cantos en una transacción (1 = editar un canto; más = importar una carpeta)
+static bool escribir(sqlite3* db, CacheSentencias& sql, std::mt19937& rng, int cantos) {
+    Transaccion tx(db);
+    for (int i = 0; i < cantos; ++i) if (!escribir_canto(db, sql, rng)) return false;
+    return tx.confirmar();
+}
+
+static void reportar(const char* nombre, std::vector<double>& us) {
+    if (us.empty()) { std::cout << "    " << nombre << ": sin muestras" << std::endl; return; }
+    std::sort(us.begin(), us.end());
+    auto p = [&](double q) { return us[std::min(us.size() - 1, static_cast<size_t>(q * us.size()))]; };
+    std::printf("    %s: %7zu ops  p50 %8.1f us  p99 %8.1f us  max %9.1f us\n", nombre, us.size(), p(0.50), p(0.99), us.back());
+}
+
+// Corre `lectores` hilos de lectura y un hilo de escritura durante `segundos`.
+// leer_con(consulta) y escribir_con(rng) hacen una operación completa, con sus bloqueos.
+template <typename Leer, typename Escribir>
+static bool correr(const char* modo, int lectores, double segundos, Leer&& leer_con, Escribir&& escribir_con) {
+    std::atomic<bool> fin{false}; std::atomic<size_t> errores{0};
+    std::vector<std::vector<double>> lecturas(lectores);
+    std::vector<double> escrituras;
+    std::vector<std::thread> hilos;
+    for (int i = 0; i < lectores; ++i) hilos.emplace_back([&, i] {
+        std::mt19937 rng(100 + i);
+        while (!fin) {
+            const std::string& palabra = vocabulario()[rng() % vocabulario().size()];
+            std::string consulta = palabra.substr(0, std::min<size_t>(palabra.size(), 4 + rng() % 3)) + "*";
+            auto t0 = Reloj::now();
+            if (!leer_con(consulta)) errores++;
+            lecturas[i].push_back(std::chrono::duration<double, std::micro>(Reloj::now() - t0).count());
+            std::this_thread::sleep_for(std::chrono::milliseconds(10)); // tecla siguiente
+        }
+    });
+    hilos.emplace_back([&] {
+        std::mt19937 rng(7);
+        while (!fin) {
+            auto t0 = Reloj::now();
+            if (!escribir_con(rng)) errores++;
+            escrituras.push_back(std::chrono::duration<double, std::micro>(Reloj::now() - t0).count());
+            std::this_thread::sleep_for(std::chrono::milliseconds(20)); // el operador no guarda sin parar
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::duration<double>(segundos));
+    fin = true;
+    for (auto& h : hilos) h.join();
+    std::vector<double> todas;
+    for (auto& l : lecturas) todas.insert(todas.end(), l.begin(), l.end());
+    std::cout << "  " << modo << std::endl;
+    reportar("lectura  ", todas);
+    reportar("escritura", escrituras);
+    if (errores) std::cerr << "  FALLO: " << errores << " operaciones con error" << std::endl;
+    return errores == 0;
+}
+
+int main(int argc, char** argv) {
+    int lectores = argc > 1 ? std::stoi(argv[1]) : 2;
+    double segundos = argc > 2 ? std::stod(argv[2]) : 3.0;
+    int por_escritura = argc > 3 ? std::stoi(argv[3]) : 20;
+    int cantos = argc > 4 ? std::stoi(argv[4]) : 2000;
+    std::string ruta = (std::filesystem::temp_directory_path() / "bench_conexiones.db").string();
+    bool ok = true;
+
+    std::cout << "Carga mixta: " << lectores << " lectores + 1 escritor, " << segundos << " s por modo, " << por_escritura << " cantos por escritura, " << cantos << " cantos iniciales" << std::endl;
+
+    // Antes: una sola conexión y un mutex global para todo
+    crear_base(ruta, cantos);
+    {
+        ConexionSqlite con; std::mutex db_mutex;
+        sqlite3_open(ruta.c_str(), &con.db); con.sql.set_conexion(con.db);
+        sqlite3_exec(con.db, "PRAGMA synchronous = NORMAL", nullptr, nullptr, nullptr);
+        ok &= correr("mutex global (1 conexión)", lectores, segundos,
+            [&](const std::string& q) { std::lock_guard<std::mutex> lock(db_mutex); return leer(con.sql, q); },
+            [&](std::mt19937& rng) { std::lock_guard<std::mutex> lock(db_mutex); return escribir(con.db, con.sql, rng, por_escritura); });
+    }
+
+    // Ahora: pool de lectores de solo lectura y un escritor con su propio mutex
+    crear_base(ruta, cantos);
+    {
+        ConexionSqlite escritor; std::mutex escritura_mutex; PoolLectura pool;
+        sqlite3_open(ruta.c_str(), &escritor.db); escritor.sql.set_conexion(escritor.db);
+        sqlite3_exec(escritor.db, "PRAGMA synchronous = NORMAL", nullptr, nullptr, nullptr);
+        pool.abrir(ruta, static_cast<size_t>(lectores));
+        ok &= correr("pool de lectura + escritor", lectores, segundos,
+            [&](const std::string& q) { auto c = pool.prestar(); return c && leer(c->sql, q); },
+            [&](std::mt19937& rng) { std::lock_guard<std::mutex> lock(escritura_mutex); return escribir(escritor.db, escritor.sql, rng, por_escritura); });
+        auto s = pool.get_estadisticas();
+        std::cout << "    pool: " << s.conexiones << " conexiones, " << s.prestamos << " préstamos, " << s.esperas << " esperas" << std::endl;
+        pool.cerrar();
+    }
+
+    std::remove(ruta.c_str()); std::remove((ruta + "-wal").c_str()); std::remove((ruta + "-shm").c_str());
+    return ok ? 0 : 1;
+}
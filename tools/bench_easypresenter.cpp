@@ -0,0 +1,335 @@
+// bench_easypresenter: benchmarks de la capa de datos (AppState) sin interfaz. Al arrancar genera
+// bases sintéticas del tamaño pedido: cantos.db y biblias.db, leída desde SQLite y desde biblias.pack,
+// y un fondo JPEG de 3840x2160 catalogado en multimedia.db.
+//
+//   bench_easypresenter [--cantos=N] [--versiones=N] [--libros=N] [--capitulos=N] [--versos=N] [--datos=carpeta]
+//                       [opciones de Google Benchmark]
+//
+// Para comparar dos versiones: --benchmark_out=antes.json --benchmark_out_format=json en cada una y
+// después tools/compare.py de Google Benchmark (compare.py benchmarks antes.json despues.json).
+// Los tamaños de las bases quedan en el "context" del JSON.
+#include "app_state.h"
+#include "imagenes.h"
+#include "indice_libros.h"
+#include "multimedia.h"
+#include "paquete_biblia.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct Tamanos { int cantos = 2000; int versiones = 3; int libros = 66; int capitulos = 20; int versos = 25; };
+
+// Nombres reales de biblias.db, para que procesar_versiones les dé sigla y prioridad como en la app
+static const char* NOMBRES_VERSIONES[] = { "ReinaValera1960", "NuevaVersiónInternacional", "NuevaTraduccionViviente", "BibliaDeLasAméricas",
+                                           "NuevaBibliadelasAméricas", "TraduccionLenguajeActual", "DiosHablaHoy", "LaPalabra" };
+
+// Vocabulario sintético de sílabas: unas 4000 palabras, así las búsquedas son tan selectivas como en un cancionero real
+static const std::vector<std::string>& vocabulario() {
+    static const std::vector<std::string> palabras = [] {
+        static const char* SILABAS[] = { "ma", "ra", "sal", "glo", "ri", "a", "se", "ñor", "cie", "lo", "san", "to", "gra", "cia", "vi", "da",
+                                         "cruz", "luz", "re", "y", "pa", "z", "go", "zo", "no", "bre", "fi", "el", "es", "pí", "tu", "can" };
+        std::vector<std::string> v; std::mt19937 rng(3);
+        for (int i = 0; i < 4000; ++i) { std::string w; for (int s = 2 + rng() % 2; s > 0; --s) w += SILABAS[rng() % std::size(SILABAS)]; v.push_back(w); }
+        return v;
+    }();
+    return palabras;
+}
+
+static std::string frase(std::mt19937& rng, int palabras) {
+    const auto& v = vocabulario(); std::string s;
+    for (int i = 0; i < palabras; ++i) { if (i) s += ' '; s += v[rng() % v.size()]; }
+    return s;
+}
+
+// Letra con 4 a 7 estrofas de 4 líneas separadas por una línea en blanco, como la escribe el operador
+static CantoImportado canto_sintetico(std::mt19937& rng) {
+    CantoImportado c{ frase(rng, 3), "" };
+    c.letra.reserve(7 * 4 * 6 * 10);
+    for (int e = 4 + rng() % 4; e > 0; --e) {
+        if (!c.letra.empty()) c.letra += "\n\n";
+        for (int l = 0; l < 4; ++l) { if (l) c.letra += '\n'; c.letra += frase(rng, 6); }
+    }
+    return c;
+}
+
+static void ejecutar(sqlite3* db, const char* sql) {
+    char* error = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &error) != SQLITE_OK) { std::cerr << "[Bench] " << (error ? error : "?") << std::endl; sqlite3_free(error); std::exit(1); }
+}
+
+// Mismo esquema que cantos.db; el índice FTS lo crea AppState al abrir, igual que en la primera ejecución de la app
+static void crear_cantos(const fs::path& ruta, int cantos) {
+    sqlite3* db = nullptr; sqlite3_open(ruta.string().c_str(), &db);
+    ejecutar(db, "PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;"
+        "CREATE TABLE cantos (id INTEGER PRIMARY KEY AUTOINCREMENT, titulo TEXT NOT NULL, tono TEXT, categoria TEXT);"
+        "CREATE TABLE diapositivas (id INTEGER PRIMARY KEY AUTOINCREMENT, canto_id INTEGER, orden INTEGER, texto TEXT); BEGIN");
+    sqlite3_stmt* canto = nullptr; sqlite3_stmt* diapo = nullptr;
+    sqlite3_prepare_v2(db, "INSERT INTO cantos (titulo, tono, categoria) VALUES (?, '', 'Cantos')", -1, &canto, nullptr);
+    sqlite3_prepare_v2(db, "INSERT INTO diapositivas (canto_id, orden, texto) VALUES (?, ?, ?)", -1, &diapo, nullptr);
+    std::mt19937 rng(1);
+    for (int c = 0; c < cantos; ++c) {
+        auto sintetico = canto_sintetico(rng);
+        sqlite3_bind_text(canto, 1, sintetico.titulo.c_str(), -1, SQLITE_TRANSIENT); sqlite3_step(canto); sqlite3_reset(canto);
+        int id = static_cast<int>(sqlite3_last_insert_rowid(db)), orden = 1;
+        for (const auto& estrofa : dividir_estrofas(sintetico.letra)) {
+            sqlite3_bind_int(diapo, 1, id); sqlite3_bind_int(diapo, 2, orden++); sqlite3_bind_text(diapo, 3, estrofa.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_step(diapo); sqlite3_reset(diapo);
+        }
+    }
+    sqlite3_finalize(canto); sqlite3_finalize(diapo);
+    ejecutar(db, "COMMIT");
+    sqlite3_close(db);
+}
+
+// Mismo esquema que biblias.db: `versos` ± 5 versículos por capítulo
+static void crear_biblias(const fs::path& ruta, const Tamanos& t) {
+    sqlite3* db = nullptr; sqlite3_open(ruta.string().c_str(), &db);
+    ejecutar(db, "PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;"
+        "CREATE TABLE versiones(id integer primary key, nombre text);"
+        "CREATE TABLE versiculos(id integer primary key, version_id int, libro_numero int, libro_nombre text, capitulo int, versiculo int, texto text);"
+        "CREATE INDEX idx_v on versiculos(version_id, libro_numero, capitulo); BEGIN");
+    sqlite3_stmt* version = nullptr; sqlite3_stmt* verso = nullptr;
+    sqlite3_prepare_v2(db, "INSERT INTO versiones (id, nombre) VALUES (?, ?)", -1, &version, nullptr);
+    sqlite3_prepare_v2(db, "INSERT INTO versiculos (version_id, libro_numero, libro_nombre, capitulo, versiculo, texto) VALUES (?, ?, ?, ?, ?, ?)", -1, &verso, nullptr);
+    std::mt19937 rng(2);
+    for (int v = 1; v <= t.versiones; ++v) {
+        sqlite3_bind_int(version, 1, v); sqlite3_bind_text(version, 2, NOMBRES_VERSIONES[(v - 1) % std::size(NOMBRES_VERSIONES)], -1, SQLITE_STATIC);
+        sqlite3_step(version); sqlite3_reset(version);
+        for (int l = 1; l <= t.libros; ++l) {
+            for (int c = 1; c <= t.capitulos; ++c) {
+                for (int n = 1, total = std::max(1, t.versos - 5 + static_cast<int>(rng() % 11)); n <= total; ++n) {
+                    std::string texto = frase(rng, 18 + rng() % 12);
+                    sqlite3_bind_int(verso, 1, v); sqlite3_bind_int(verso, 2, l); sqlite3_bind_text(verso, 3, NOMBRES_LIBROS[l - 1].c_str(), -1, SQLITE_STATIC);
+                    sqlite3_bind_int(verso, 4, c); sqlite3_bind_int(verso, 5, n); sqlite3_bind_text(verso, 6, texto.c_str(), -1, SQLITE_TRANSIENT);
+                    sqlite3_step(verso); sqlite3_reset(verso);
+                }
+            }
+        }
+    }
+    sqlite3_finalize(version); sqlite3_finalize(verso);
+    ejecutar(db, "COMMIT; PRAGMA wal_checkpoint(TRUNCATE);");
+    sqlite3_close(db);
+}
+
+// AppState informa por consola al abrir; se silencia para no mezclarlo con la salida del benchmark.
+// Sin interfaz, lo que iría al hilo de la UI se ejecuta en el mismo hilo que lo entrega.
+// `en_paralelo`: como la app, cantos y biblias en dos hilos; vuelve cuando llegaron cantos y libros.
+static std::unique_ptr<AppState> abrir(const fs::path& carpeta, bool en_paralelo = false) {
+    std::ostringstream nulo; auto* anterior = std::cout.rdbuf(nulo.rdbuf());
+    auto app = std::make_unique<AppState>([](std::function<void()> trabajo) { trabajo(); }, carpeta.string());
+    if (!en_paralelo) app->abrir();
+    else {
+        auto listo = std::make_shared<std::promise<void>>(); auto faltan = std::make_shared<std::atomic<int>>(2);
+        auto terminado = listo->get_future();
+        app->abrir_en_segundo_plano([listo, faltan](Apertura etapa) { if ((etapa == Apertura::Cantos || etapa == Apertura::Libros) && --*faltan == 0) listo->set_value(); });
+        terminado.wait();
+    }
+    std::cout.rdbuf(anterior);
+    return app;
+}
+
+struct Entorno {
+    Tamanos tamanos; fs::path carpeta;
+    std::unique_ptr<AppState> sqlite, paquete; // misma biblias.db, leída de SQLite o del paquete
+    std::vector<std::string> versiones;        // nombres completos, en el orden de prioridad de la app
+    Multimedia multimedia; ElementoMultimedia fondo;
+};
+static Entorno entorno;
+
+// Capítulo número `i` de un recorrido que salta de libro en libro, para no pedir nunca el vecino
+// del anterior (la precarga ya lo habría dejado en el cache)
+static CacheKey clave_recorrido(int version_id, size_t i) {
+    const auto& t = entorno.tamanos;
+    return { version_id, 1 + static_cast<int>((i * 7) % t.libros), 1 + static_cast<int>((i * 3 + i / t.libros) % t.capitulos) };
+}
+
+static AppState& origen(bool paquete) { return paquete ? *entorno.paquete : *entorno.sqlite; }
+
+// Arranque de la capa de datos con las bases ya preparadas (índice FTS y capitulos_meta creados):
+// todo en este hilo o cantos y biblias a la vez, como abre la app
+static void apertura(benchmark::State& state, bool en_paralelo) {
+    for (auto _ : state) {
+        auto app = abrir(entorno.carpeta / "sqlite", en_paralelo);
+        state.PauseTiming(); app.reset(); state.ResumeTiming();
+    }
+}
+
+static void buscar_cantos(benchmark::State& state, std::string consulta) {
+    size_t resultados = 0;
+    for (auto _ : state) { auto lista = entorno.sqlite->get_cantos_filtrados(consulta); resultados = lista.size(); benchmark::DoNotOptimize(lista.data()); }
+    state.counters["resultados"] = static_cast<double>(resultados);
+}
+
+// Capítulo que no está en el cache: se vacía antes de cada lectura (fuera del tiempo medido)
+static void capitulo_frio(benchmark::State& state, bool paquete) {
+    AppState& app = origen(paquete); size_t i = 0;
+    for (auto _ : state) {
+        state.PauseTiming(); app.vaciar_cache_capitulos(); CacheKey key = clave_recorrido(app.get_current_version_id(), i++); state.ResumeTiming();
+        benchmark::DoNotOptimize(app.get_capitulo(key));
+    }
+}
+
+static void capitulo_caliente(benchmark::State& state, bool paquete) {
+    AppState& app = origen(paquete); CacheKey key = clave_recorrido(app.get_current_version_id(), 0);
+    app.get_capitulo(key);
+    for (auto _ : state) benchmark::DoNotOptimize(app.get_capitulo(key));
+}
+
+// Cambio de versión con un capítulo abierto, como on_bible_version_changed: hasta que el callback
+// recibe el capítulo en la otra versión. En frío el cache se vacía y el capítulo cambia en cada vuelta;
+// en caliente se alterna entre las dos versiones del mismo capítulo.
+static void cambio_version(benchmark::State& state, bool paquete, bool frio) {
+    AppState& app = origen(paquete); size_t i = 0, versos = 0;
+    if (entorno.versiones.size() < 2) { state.SkipWithError("se necesitan al menos 2 versiones"); return; }
+    for (auto _ : state) {
+        CacheKey key = clave_recorrido(0, frio ? i : 0);
+        if (frio) { state.PauseTiming(); app.vaciar_cache_capitulos(); state.ResumeTiming(); }
+        app.set_version_by_name(entorno.versiones[i++ % 2]);
+        std::promise<size_t> recibido; auto futuro = recibido.get_future();
+        app.get_capitulo_async(key.libro_numero, key.capitulo, [&recibido](CapituloPtr c) { recibido.set_value(c->size()); });
+        versos = futuro.get();
+    }
+    state.counters["versos"] = static_cast<double>(versos);
+}
+
+// Importación masiva de `state.range(0)` cantos en una cantos.db vacía (con índice FTS), incluido
+// el corte en diapositivas. Cada vuelta empieza con una base nueva, creada fuera del tiempo medido.
+static void importar_cantos(benchmark::State& state) {
+    std::mt19937 rng(5); std::vector<CantoImportado> cantos;
+    for (int64_t i = 0; i < state.range(0); ++i) cantos.push_back(canto_sintetico(rng));
+    // Las biblias no se tocan: se copian una vez para que AppState abra igual que en la app
+    fs::path carpeta = entorno.carpeta / "importacion";
+    fs::remove_all(carpeta); fs::create_directories(carpeta); fs::copy_file(entorno.carpeta / "sqlite" / "biblias.db", carpeta / "biblias.db");
+    size_t diapositivas = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (const char* sufijo : { "", "-wal", "-shm" }) fs::remove(carpeta / (std::string("cantos.db") + sufijo));
+        crear_cantos(carpeta / "cantos.db", 0);
+        auto app = abrir(carpeta);
+        state.ResumeTiming();
+        auto res = app->importar_cantos(cantos);
+        state.PauseTiming(); diapositivas = res.diapositivas; app.reset(); state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["diapositivas"] = static_cast<double>(diapositivas);
+    fs::remove_all(carpeta);
+}
+
+// Foto sintética de 3840x2160 (degradados con algo de ruido, para que el JPEG pese como una foto real)
+static bool crear_fondo(const fs::path& ruta) {
+    constexpr uint32_t ANCHO = 3840, ALTO = 2160; std::vector<uint8_t> rgba(static_cast<size_t>(ANCHO) * ALTO * 4);
+    std::mt19937 rng(11); std::uniform_int_distribution<int> ruido(-12, 12);
+    for (uint32_t y = 0; y < ALTO; ++y) for (uint32_t x = 0; x < ANCHO; ++x) {
+        uint8_t* p = &rgba[(static_cast<size_t>(y) * ANCHO + x) * 4];
+        p[0] = static_cast<uint8_t>(std::clamp(static_cast<int>(255.0 * x / ANCHO) + ruido(rng), 0, 255));
+        p[1] = static_cast<uint8_t>(std::clamp(static_cast<int>(127.5 + 127.5 * std::sin(y / 90.0)) + ruido(rng), 0, 255));
+        p[2] = static_cast<uint8_t>(std::clamp(static_cast<int>(255.0 * y / ALTO) + ruido(rng), 0, 255)); p[3] = 255;
+    }
+    auto jpeg = imagenes::codificar_jpeg(rgba.data(), ANCHO, ALTO, 90);
+    std::ofstream salida(ruta, std::ios::binary); salida.write(reinterpret_cast<const char*>(jpeg.data()), static_cast<std::streamsize>(jpeg.size()));
+    return !jpeg.empty() && salida.good();
+}
+
+// Fondo del proyector desde el archivo, decodificado y escalado (con recorte: "cover") a ancho x alto,
+// como en GaleriaImagenes::fondo. A 3840x2160 se decodifica completo; más chico, libjpeg reduce al decodificar.
+static void fondo(benchmark::State& state) {
+    uint32_t ancho = static_cast<uint32_t>(state.range(0)), alto = static_cast<uint32_t>(state.range(1));
+    std::vector<uint8_t> buffer;
+    auto reservar = [&buffer](uint32_t a, uint32_t h) { buffer.resize(static_cast<size_t>(a) * h * 4); return buffer.data(); };
+    for (auto _ : state) {
+        auto r = imagenes::decodificar_archivo(entorno.fondo.ruta, ancho, alto, imagenes::Ajuste::Cubrir, reservar);
+        if (!r.ok) { state.SkipWithError(r.error.c_str()); return; }
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+}
+
+// Miniatura ya guardada en multimedia.db (lo normal al abrir la galería desde el segundo arranque)
+static void miniatura_guardada(benchmark::State& state) {
+    std::vector<uint8_t> buffer;
+    auto reservar = [&buffer](uint32_t a, uint32_t h) { buffer.resize(static_cast<size_t>(a) * h * 4); return buffer.data(); };
+    if (!entorno.multimedia.miniatura(entorno.fondo, reservar).ok) { state.SkipWithError("no se pudo generar la miniatura"); return; }
+    for (auto _ : state) benchmark::DoNotOptimize(entorno.multimedia.miniatura(entorno.fondo, reservar).ok);
+}
+
+static bool leer_opcion(const std::string& arg, const char* nombre, int& valor) {
+    std::string prefijo = std::string("--") + nombre + "=";
+    if (arg.compare(0, prefijo.size(), prefijo) != 0) return false;
+    valor = std::stoi(arg.substr(prefijo.size())); return true;
+}
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    auto& t = entorno.tamanos; bool carpeta_propia = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (leer_opcion(arg, "cantos", t.cantos) || leer_opcion(arg, "versiones", t.versiones) || leer_opcion(arg, "libros", t.libros) ||
+            leer_opcion(arg, "capitulos", t.capitulos) || leer_opcion(arg, "versos", t.versos)) continue;
+        if (arg.rfind("--datos=", 0) == 0) { entorno.carpeta = arg.substr(8); carpeta_propia = true; continue; }
+        std::cerr << "Opción desconocida: " << arg << std::endl; return 2;
+    }
+    t.cantos = std::max(t.cantos, 1); t.versiones = std::clamp(t.versiones, 1, static_cast<int>(std::size(NOMBRES_VERSIONES)));
+    t.libros = std::clamp(t.libros, 1, static_cast<int>(NOMBRES_LIBROS.size())); t.capitulos = std::max(t.capitulos, 1); t.versos = std::max(t.versos, 1);
+    if (!carpeta_propia) entorno.carpeta = fs::temp_directory_path() / "bench_easypresenter";
+
+    // Las bases se generan siempre de nuevo: `--datos` solo elige dónde
+    fs::path dir_sqlite = entorno.carpeta / "sqlite", dir_paquete = entorno.carpeta / "paquete";
+    fs::remove_all(dir_sqlite); fs::remove_all(dir_paquete); fs::create_directories(dir_sqlite); fs::create_directories(dir_paquete);
+    crear_cantos(dir_sqlite / "cantos.db", t.cantos); crear_biblias(dir_sqlite / "biblias.db", t);
+    crear_cantos(dir_paquete / "cantos.db", 0); fs::copy_file(dir_sqlite / "biblias.db", dir_paquete / "biblias.db");
+    std::string error;
+    if (!paquete_biblia::empaquetar(dir_paquete / "biblias.db", dir_paquete / "biblias.pack", error)) { std::cerr << "[Bench] " << error << std::endl; return 1; }
+    entorno.sqlite = abrir(dir_sqlite); entorno.paquete = abrir(dir_paquete);
+    fs::path dir_multimedia = entorno.carpeta / "multimedia"; fs::remove_all(dir_multimedia); fs::create_directories(dir_multimedia);
+    if (!crear_fondo(dir_multimedia / "fondo.jpg") || !entorno.multimedia.abrir((dir_multimedia / "multimedia.db").string())) { std::cerr << "[Bench] No se pudo preparar multimedia" << std::endl; return 1; }
+    auto agregadas = entorno.multimedia.agregar_imagenes((dir_multimedia / "fondo.jpg").string());
+    if (agregadas.empty()) { std::cerr << "[Bench] No se pudo catalogar el fondo" << std::endl; return 1; }
+    entorno.fondo = agregadas.front();
+    for (const auto& v : entorno.sqlite->get_versiones()) entorno.versiones.push_back(v.nombre_completo);
+
+    benchmark::AddCustomContext("cantos", std::to_string(t.cantos));
+    benchmark::AddCustomContext("versiones", std::to_string(t.versiones));
+    benchmark::AddCustomContext("libros", std::to_string(t.libros));
+    benchmark::AddCustomContext("capitulos_por_libro", std::to_string(t.capitulos));
+    benchmark::AddCustomContext("versos_por_capitulo", std::to_string(t.versos));
+    benchmark::AddCustomContext("sqlite", sqlite3_libversion());
+
+    benchmark::RegisterBenchmark("apertura/secuencial", apertura, false)->Unit(benchmark::kMillisecond)->UseRealTime();
+    benchmark::RegisterBenchmark("apertura/paralela", apertura, true)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Consultas sacadas de la base generada: prefijo corto (solo títulos), una palabra de un título,
+    // dos palabras seguidas de una diapositiva y un prefijo que coincide con casi todo
+    std::string titulo = entorno.sqlite->get_canto_titulo(1), estrofa = entorno.sqlite->get_canto_diapositivas(1).front().texto;
+    benchmark::RegisterBenchmark("buscar_cantos/2_letras", buscar_cantos, titulo.substr(0, 2));
+    benchmark::RegisterBenchmark("buscar_cantos/palabra", buscar_cantos, titulo.substr(0, titulo.find(' ')));
+    benchmark::RegisterBenchmark("buscar_cantos/dos_palabras", buscar_cantos, estrofa.substr(0, estrofa.find(' ', estrofa.find(' ') + 1)));
+    benchmark::RegisterBenchmark("buscar_cantos/generica", buscar_cantos, std::string("gra"));
+    for (bool paquete : { false, true }) {
+        std::string o = paquete ? "/paquete" : "/sqlite";
+        benchmark::RegisterBenchmark(("capitulo_frio" + o).c_str(), capitulo_frio, paquete);
+        benchmark::RegisterBenchmark(("capitulo_caliente" + o).c_str(), capitulo_caliente, paquete);
+        benchmark::RegisterBenchmark(("cambio_version" + o + "/frio").c_str(), cambio_version, paquete, true);
+        benchmark::RegisterBenchmark(("cambio_version" + o + "/caliente").c_str(), cambio_version, paquete, false);
+    }
+    benchmark::RegisterBenchmark("importar_cantos", importar_cantos)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark("fondo_jpeg_4k", fondo)->Args({ 3840, 2160 })->Args({ 1920, 1080 })->Args({ 1280, 720 })->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark("miniatura_guardada", miniatura_guardada)->Unit(benchmark::kMicrosecond);
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    entorno.sqlite.reset(); entorno.paquete.reset(); entorno.multimedia.cerrar();
+    if (!carpeta_propia) fs::remove_all(entorno.carpeta);
+    return 0;
+}
@@ -0,0 +1,76 @@
+// bench_libros: verifica el índice de libros de la búsqueda rápida y mide cuánto cuesta
+// cada tecla frente al recorrido lineal anterior.
+//
+//   bench_libros [iteraciones]
+//   bench_libros --verificar      solo los casos, sin medir (lo corre ctest); sale con 1 si alguno falla
+#include "indice_libros.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Implementación anterior: ::tolower byte a byte y recorrido lineal de NOMBRES_LIBROS
+static std::string to_lower(const std::string& str) {
+    std::string lower_str = str;
+    std::transform(lower_str.begin(), lower_str.end(), lower_str.begin(), ::tolower);
+    return lower_str;
+}
+static std::string buscar_lineal(const std::string& q_original, int& out_id) {
+    std::string q = to_lower(q_original);
+    if (q.empty()) return "";
+    for (size_t i = 0; i < NOMBRES_LIBROS.size(); ++i)
+        if (to_lower(NOMBRES_LIBROS[i]).find(q) == 0) { out_id = static_cast<int>(i + 1); return NOMBRES_LIBROS[i]; }
+    return "";
+}
+
+struct Caso { const char* consulta; int esperado; }; // esperado 0: sin coincidencia
+
+static const Caso CASOS[] = {
+    {"gen", 1}, {"Génesis", 1}, {"GÉNESIS", 1}, {"genesis", 1}, {"Ge\xCC\x81nesis", 1}, {"Gn", 1}, {"gn.", 1},
+    {"éx", 2}, {"Éxodo", 2}, {"EXODO", 2}, {"ex", 2}, {"lev", 3}, {"num", 4}, {"Núm", 4}, {"dt", 5},
+    {"jo", 6}, {"josue", 6}, {"jue", 7}, {"job", 18}, {"jb", 18}, {"joel", 29}, {"jon", 32}, {"jonás", 32},
+    {"1 s", 9}, {"1s", 9}, {"2 sam", 10}, {"1 r", 11}, {"1 Cr", 13}, {"2cro", 14}, {"es", 15}, {"est", 17},
+    {"sal", 19}, {"Sal", 19}, {"sl", 19}, {"salmos", 19}, {"pr", 20}, {"ec", 21}, {"cant", 22}, {"isaias", 23},
+    {"ISAÍAS", 23}, {"lam", 25}, {"ez", 26}, {"am", 30}, {"amós", 30}, {"abd", 31}, {"nahum", 34}, {"sofonias", 36},
+    {"zac", 38}, {"mal", 39}, {"mt", 40}, {"ma", 39}, {"mr", 41}, {"mc", 41}, {"lc", 42}, {"jn", 43}, {"juan", 43},
+    {"he", 44}, {"hch", 44}, {"heb", 58}, {"ro", 45}, {"1 co", 46}, {"1co", 46}, {"1 Corintios", 46}, {"2 co", 47},
+    {"gá", 48}, {"galatas", 48}, {"ef", 49}, {"fil", 50}, {"flp", 50}, {"filem", 57}, {"flm", 57}, {"col", 51},
+    {"1 ts", 52}, {"1 tes", 52}, {"2 ti", 55}, {"tit", 56}, {"stg", 59}, {"santiago", 59}, {"1 p", 60}, {"2 pe", 61},
+    {"1 jn", 62}, {"1 juan", 62}, {"3 jn", 64}, {"jud", 65}, {"ap", 66}, {"apocalipsis", 66},
+    {"", 0}, {"   ", 0}, {"x", 0}, {"genesiss", 0}, {"juan 3", 0}, {"4 juan", 0}, {"salmos salmos salmos", 0},
+};
+
+int main(int argc, char** argv) {
+    bool solo_verificar = argc > 1 && std::string(argv[1]) == "--verificar";
+    size_t iteraciones = argc > 1 && !solo_verificar ? std::stoul(argv[1]) : 200000;
+    IndiceLibros indice;
+
+    size_t fallos = 0;
+    for (const auto& caso : CASOS) {
+        int id = 0; std::string_view nombre = indice.buscar(caso.consulta, id);
+        int obtenido = nombre.empty() ? 0 : id;
+        if (obtenido != caso.esperado) {
+            std::cerr << "FALLO \"" << caso.consulta << "\": esperado " << caso.esperado << ", obtenido " << obtenido << " (" << nombre << ")" << std::endl;
+            fallos++;
+        }
+    }
+    std::cout << "Verificación: " << (sizeof(CASOS) / sizeof(CASOS[0])) - fallos << "/" << sizeof(CASOS) / sizeof(CASOS[0]) << " casos correctos" << std::endl;
+    if (solo_verificar) return fallos == 0 ? 0 : 1;
+
+    // Lo que teclea el operador: cada prefijo de cada nombre, carácter por carácter
+    std::vector<std::string> teclas;
+    for (const auto& n : NOMBRES_LIBROS)
+        for (size_t i = 1; i <= n.size(); ++i) if (i == n.size() || (static_cast<unsigned char>(n[i]) & 0xC0) != 0x80) teclas.push_back(n.substr(0, i));
+    auto medir = [&](const char* nombre, auto&& buscar) {
+        size_t encontrados = 0;
+        auto inicio = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iteraciones; ++i) { int id = 0; if (!buscar(teclas[i % teclas.size()], id).empty()) encontrados++; }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - inicio).count() / iteraciones;
+        std::cout << "  " << nombre << ": " << ns << " ns por tecla (" << encontrados << " coincidencias)" << std::endl;
+    };
+    std::cout << "Búsqueda por tecla (" << iteraciones << " consultas)" << std::endl;
+    medir("recorrido lineal", [](const std::string& q, int& id) { return buscar_lineal(q, id); });
+    medir("índice          ", [&indice](const std::string& q, int& id) { return indice.buscar(q, id); });
+    return fallos == 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// bench_referencias: verifica el parser de referencias bíblicas con un corpus fijo y con
+// entradas mutadas al azar, y lo compara con la expresión regular que se usaba antes.
+//
+//   bench_referencias [iteraciones] [mutaciones]
+//   bench_referencias --verificar   corpus y mutaciones, sin medir (lo corre ctest); sale con 1 si algo falla
+#include "referencia_biblica.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+struct Caso { const char* texto; bool valida; const char* libro; int capitulo; int verso_inicio; int verso_fin; };
+
+static const Caso CORPUS[] = {
+    {"Jn 3:16", true, "Jn", 3, 16, 16},
+    {"Juan 3 16", true, "Juan", 3, 16, 16},
+    {"  Juan   3   16  ", true, "Juan", 3, 16, 16},
+    {"1 Co 13:4-7", true, "1 Co", 13, 4, 7},
+    {"1Co 13:4 - 7", true, "1Co", 13, 4, 7},
+    {"Sal 23, 1-3", true, "Sal", 23, 1, 3},
+    {"Sal 23.1", true, "Sal", 23, 1, 1},
+    {"Sal 119:176", true, "Sal", 119, 176, 176},
+    {"Jn3:16", true, "Jn", 3, 16, 16},
+    {"Jn. 3:16", true, "Jn", 3, 16, 16},
+    {"Rut 2", true, "Rut", 2, 0, 0},
+    {"2Tim 3:16", true, "2Tim", 3, 16, 16},
+    {"3 Juan 1:4", true, "3 Juan", 1, 4, 4},
+    {"Génesis 1:1", true, "Génesis", 1, 1, 1},
+    {"Éxodo 20:1\xE2\x80\x93" "17", true, "Éxodo", 20, 1, 17},
+    {"Cantar de los Cantares 2:4", true, "Cantar de los Cantares", 2, 4, 4},
+    {"4:8", true, "", 4, 8, 8},
+    {"23", true, "", 23, 0, 0},
+    {"", false, "", 0, 0, 0},
+    {"Juan", false, "", 0, 0, 0},
+    {"Juan 0", false, "", 0, 0, 0},
+    {"Juan 3:0", false, "", 0, 0, 0},
+    {"Juan 3:", false, "", 0, 0, 0},
+    {"Juan 3:16-", false, "", 0, 0, 0},
+    {"Juan 3:16-12", false, "", 0, 0, 0},
+    {"Juan 3:16 hola", false, "", 0, 0, 0},
+    {"Juan 1000", false, "", 0, 0, 0},
+    {"Juan 3::16", false, "", 0, 0, 0},
+};
+
+// Cadenas encadenadas: cuántas referencias se leen antes de parar
+struct Cadena { const char* texto; int referencias; };
+static const Cadena CADENAS[] = {
+    {"Jn 3:16; Ro 8:28", 2}, {"Jn 3:16; 4:8; 5:1-3", 3}, {"Jn 3:16;;  ; Sal 23", 2}, {"Jn 3:16; basura; Ro 8", 1}, {" ; ", 0},
+};
+
+// Ruta anterior: una std::regex nueva en cada Enter
+static bool parsear_regex(const std::string& q, int& capitulo, int& verso) {
+    std::regex re(R"(^\s*(.*?)\s+(\d+)(?:\s+(\d+))?\s*$)");
+    std::smatch match;
+    if (!std::regex_match(q, match, re)) return false;
+    capitulo = std::stoi(match[2].str()); verso = match[3].matched ? std::stoi(match[3].str()) : 1; return true;
+}
+
+int main(int argc, char** argv) {
+    bool solo_verificar = argc > 1 && std::string(argv[1]) == "--verificar";
+    size_t iteraciones = argc > 1 && !solo_verificar ? std::stoul(argv[1]) : 100000;
+    size_t mutaciones = argc > 2 ? std::stoul(argv[2]) : 200000;
+    size_t fallos = 0;
+
+    for (const auto& c : CORPUS) {
+        std::string_view texto = c.texto; ReferenciaBiblica r;
+        bool ok = leer_referencia(texto, r);
+        bool igual = ok == c.valida && (!ok || (r.libro == c.libro && r.capitulo == c.capitulo && r.verso_inicio == c.verso_inicio && r.verso_fin == c.verso_fin));
+        if (!igual) { std::cerr << "FALLO \"" << c.texto << "\": " << ok << " libro=\"" << r.libro << "\" " << r.capitulo << ":" << r.verso_inicio << "-" << r.verso_fin << std::endl; fallos++; }
+    }
+    for (const auto& c : CADENAS) {
+        std::string_view texto = c.texto; ReferenciaBiblica r; int n = 0;
+        while (leer_referencia(texto, r)) n++;
+        if (n != c.referencias) { std::cerr << "FALLO cadena \"" << c.texto << "\": " << n << " referencias" << std::endl; fallos++; }
+    }
+    std::cout << "Corpus: " << (std::size(CORPUS) + std::size(CADENAS)) - fallos << "/" << std::size(CORPUS) + std::size(CADENAS) << " casos correctos" << std::endl;
+
+    // Mutaciones al azar del corpus: el parser nunca debe salirse del texto ni devolver valores incoherentes
+    std::mt19937 rng(7);
+    const std::string alfabeto = "0123456789 :,.;-abcJnSal\xC3\xA9\xE2\x80\x93\t";
+    size_t aceptadas = 0, invalidas = 0;
+    for (size_t i = 0; i < mutaciones; ++i) {
+        std::string s = CORPUS[rng() % std::size(CORPUS)].texto;
+        for (int m = rng() % 4; m >= 0; --m) {
+            size_t pos = s.empty() ? 0 : rng() % (s.size() + 1);
+            switch (rng() % 3) {
+                case 0: s.insert(s.begin() + pos, alfabeto[rng() % alfabeto.size()]); break;
+                case 1: if (pos < s.size()) s.erase(pos, 1); break;
+                default: s.resize(pos); break;
+            }
+        }
+        std::string_view texto = s; ReferenciaBiblica r;
+        while (leer_referencia(texto, r)) {
+            aceptadas++;
+            bool dentro = r.libro.empty() || (r.libro.data() >= s.data() && r.libro.data() + r.libro.size() <= s.data() + s.size());
+            bool coherente = r.capitulo > 0 && r.capitulo < 1000 && r.verso_fin >= r.verso_inicio && (r.verso_inicio == 0) == (r.verso_fin == 0);
+            if (!dentro || !coherente) { if (invalidas++ < 5) std::cerr << "FALLO mutación \"" << s << "\"" << std::endl; }
+            if (texto.size() > s.size()) { invalidas++; break; }
+        }
+    }
+    fallos += invalidas;
+    std::cout << "Mutaciones: " << mutaciones << " entradas, " << aceptadas << " referencias aceptadas, " << invalidas << " incoherentes" << std::endl;
+    if (solo_verificar) return fallos == 0 ? 0 : 1;
+
+    std::vector<std::string> entradas = { "Juan 3 16", "Salmos 23 1", "1 Corintios 13 4", "Génesis 1", "Apocalipsis 22 21" };
+    auto medir = [&](const char* nombre, auto&& parsear) {
+        size_t aciertos = 0;
+        auto inicio = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iteraciones; ++i) aciertos += parsear(entradas[i % entradas.size()]);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - inicio).count() / iteraciones;
+        std::cout << "  " << nombre << ": " << ns << " ns por referencia (" << aciertos << " aceptadas)" << std::endl;
+    };
+    std::cout << "Parseo (" << iteraciones << " referencias)" << std::endl;
+    medir("std::regex", [](const std::string& q) { int c, v; return parsear_regex(q, c, v); });
+    medir("parser    ", [](const std::string& q) { std::string_view t = q; ReferenciaBiblica r; return leer_referencia(t, r); });
+    return fallos == 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// biblia_pack: compila biblias.db al paquete binario que EasyPresenter mapea en memoria.
+//
+//   biblia_pack <biblias.db> [biblias.pack]              genera el paquete (por defecto junto a la base)
+//   biblia_pack --bench <biblias.db> [biblias.pack] [n]  compara la carga de capítulos SQLite vs paquete
+#include "paquete_biblia.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using paquete_biblia::PaqueteBiblia;
+
+struct Versiculo { int capitulo; int versiculo; std::string texto; };
+struct Clave { int version_id; int libro_numero; int capitulo; };
+
+static void imprimir_latencias(const std::string& nombre, std::vector<double>& us) {
+    std::sort(us.begin(), us.end());
+    double total = 0; for (double x : us) total += x;
+    auto pct = [&us](double p) { return us[std::min(us.size() - 1, static_cast<size_t>(p * us.size()))]; };
+    std::cout << "  " << nombre << ": media " << total / us.size() << " us | p50 " << pct(0.50) << " us | p99 " << pct(0.99) << " us | max " << us.back() << " us" << std::endl;
+}
+
+static int bench(const fs::path& ruta_db, const fs::path& ruta_paquete, size_t iteraciones) {
+    PaqueteBiblia paquete;
+    if (!paquete.abrir(ruta_paquete, ruta_db)) { std::cerr << "El paquete falta o está desactualizado: " << ruta_paquete << std::endl; return 1; }
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(ruta_db.string().c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) { std::cerr << "No se pudo abrir " << ruta_db << std::endl; return 1; }
+
+    // Todos los capítulos existentes, para elegir al azar
+    std::vector<Clave> claves;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT DISTINCT version_id, libro_numero, capitulo FROM versiculos", -1, &stmt, nullptr) == SQLITE_OK)
+        while (sqlite3_step(stmt) == SQLITE_ROW) claves.push_back({ sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1), sqlite3_column_int(stmt, 2) });
+    sqlite3_finalize(stmt);
+    if (claves.empty()) { std::cerr << "biblias.db no tiene versículos" << std::endl; sqlite3_close(db); return 1; }
+    std::mt19937 rng(42); std::uniform_int_distribution<size_t> dist(0, claves.size() - 1);
+    std::vector<Clave> muestra(iteraciones); for (auto& c : muestra) c = claves[dist(rng)];
+
+    // Misma consulta que AppState, preparada una sola vez
+    sqlite3_prepare_v2(db, "SELECT versiculo, texto FROM versiculos WHERE version_id = ? AND libro_numero = ? AND capitulo = ? ORDER BY versiculo", -1, &stmt, nullptr);
+    std::vector<double> t_sqlite, t_paquete, t_vista; size_t versos_sqlite = 0, versos_paquete = 0, bytes_vista = 0;
+    for (const auto& k : muestra) {
+        auto inicio = std::chrono::steady_clock::now();
+        std::vector<Versiculo> lista;
+        sqlite3_bind_int(stmt, 1, k.version_id); sqlite3_bind_int(stmt, 2, k.libro_numero); sqlite3_bind_int(stmt, 3, k.capitulo);
+        while (sqlite3_step(stmt) == SQLITE_ROW) lista.push_back({ k.capitulo, sqlite3_column_int(stmt, 0), reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)) });
+        sqlite3_reset(stmt);
+        t_sqlite.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - inicio).count());
+        versos_sqlite += lista.size();
+    }
+    sqlite3_finalize(stmt); sqlite3_close(db);
+    for (const auto& k : muestra) {
+        // Lo que hace AppState con el paquete: copiar al vector del cache
+        auto inicio = std::chrono::steady_clock::now();
+        auto cap = paquete.capitulo(k.version_id, k.libro_numero, k.capitulo);
+        std::vector<Versiculo> lista; lista.reserve(cap.size());
+        for (size_t i = 0; i < cap.size(); ++i) { auto v = cap[i]; lista.push_back({ k.capitulo, v.numero, std::string(v.texto) }); }
+        t_paquete.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - inicio).count());
+        versos_paquete += lista.size();
+    }
+    for (const auto& k : muestra) {
+        // Solo la vista, sin copias
+        auto inicio = std::chrono::steady_clock::now();
+        auto cap = paquete.capitulo(k.version_id, k.libro_numero, k.capitulo);
+        for (size_t i = 0; i < cap.size(); ++i) bytes_vista += cap[i].texto.size();
+        t_vista.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - inicio).count());
+    }
+
+    std::cout << "Carga de capítulo (" << iteraciones << " capítulos al azar de " << claves.size() << ")" << std::endl;
+    imprimir_latencias("SQLite          ", t_sqlite);
+    imprimir_latencias("paquete (copia) ", t_paquete);
+    imprimir_latencias("paquete (vista) ", t_vista);
+    if (versos_sqlite != versos_paquete) { std::cerr << "ERROR: el paquete no coincide con SQLite (" << versos_paquete << " vs " << versos_sqlite << " versículos)" << std::endl; return 1; }
+    return bytes_vista > 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    bool modo_bench = !args.empty() && args[0] == "--bench";
+    if (modo_bench) args.erase(args.begin());
+    if (args.empty()) {
+        std::cerr << "Uso: biblia_pack <biblias.db> [biblias.pack]\n       biblia_pack --bench <biblias.db> [biblias.pack] [iteraciones]" << std::endl;
+        return 2;
+    }
+    fs::path ruta_db = args[0];
+    fs::path ruta_paquete = args.size() > 1 ? fs::path(args[1]) : fs::path(ruta_db).replace_extension(".pack");
+    if (modo_bench) return bench(ruta_db, ruta_paquete, args.size() > 2 ? std::stoul(args[2]) : 2000);
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::string error;
+    if (!paquete_biblia::empaquetar(ruta_db, ruta_paquete, error)) { std::cerr << "Error: " << error << std::endl; return 1; }
+    std::error_code ec; auto bytes = fs::file_size(ruta_paquete, ec);
+    std::cout << "Paquete generado: " << ruta_paquete.string() << " (" << bytes / 1024 << " KB) en "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count() << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,53 @@
+// prueba_busqueda: verifica que una búsqueda de 1-2 caracteres devuelva los primeros títulos en orden
+// alfabético de toda la biblioteca, no los más nuevos (el índice FTS guarda los títulos con rowid = -id).
+//
+//   prueba_busqueda      (lo corre ctest); sale con 1 si algún caso falla
+#include "app_state.h"
+#include <sqlite3.h>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static std::string titulo(int i) { char t[32]; std::snprintf(t, sizeof(t), "Alaba %03d", i); return t; }
+
+int main() {
+    static constexpr int CANTOS = 300, LIMITE = 100;
+    fs::path carpeta = fs::temp_directory_path() / "prueba_busqueda";
+    fs::remove_all(carpeta); fs::create_directories(carpeta);
+    size_t fallos = 0;
+    {
+        // Mismo esquema que cantos.db (el índice FTS lo crea AppState al abrir)
+        sqlite3* db = nullptr;
+        if (sqlite3_open((carpeta / "cantos.db").string().c_str(), &db) != SQLITE_OK ||
+            sqlite3_exec(db, "CREATE TABLE cantos (id INTEGER PRIMARY KEY AUTOINCREMENT, titulo TEXT NOT NULL, tono TEXT, categoria TEXT);"
+                             "CREATE TABLE diapositivas (id INTEGER PRIMARY KEY AUTOINCREMENT, canto_id INTEGER, orden INTEGER, texto TEXT);", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            std::cerr << "FALLO no se pudo preparar cantos.db" << std::endl; sqlite3_close(db); return 1;
+        }
+        sqlite3_close(db);
+        AppState app([](std::function<void()> trabajo) { trabajo(); }, carpeta.string());
+        app.abrir();
+
+        // Los ids crecen con el título: los más nuevos son los últimos en orden alfabético
+        std::vector<CantoImportado> cantos;
+        for (int i = 0; i < CANTOS; ++i) cantos.push_back({ titulo(i), "letra" });
+        app.importar_cantos(cantos);
+
+        for (const std::string busqueda : { "a", "al" }) {
+            auto lista = app.get_cantos_filtrados(busqueda, LIMITE);
+            bool ok = lista.size() == LIMITE;
+            for (size_t i = 0; ok && i < lista.size(); ++i) ok = lista[i].titulo == titulo(static_cast<int>(i));
+            if (!ok) {
+                std::cerr << "FALLO \"" << busqueda << "\": " << lista.size() << " resultados, primero \"" << (lista.empty() ? "" : lista.front().titulo)
+                          << "\", último \"" << (lista.empty() ? "" : lista.back().titulo) << "\" (esperado " << titulo(0) << " .. " << titulo(LIMITE - 1) << ")" << std::endl;
+                fallos++;
+            }
+        }
+    }
+    fs::remove_all(carpeta);
+    std::cout << "Búsqueda corta: " << (fallos ? "FALLO" : "primeros títulos en orden alfabético") << std::endl;
+    return fallos == 0 ? 0 : 1;
+}
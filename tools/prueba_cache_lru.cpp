@@ -0,0 +1,70 @@
+// prueba_cache_lru: verifica que, con el cache lleno, las precargas sobrevivan a los fallos en primer
+// plano y a las precargas siguientes (hasta llenar su segmento), y que pedirlas cuente como acierto.
+//
+//   prueba_cache_lru      (lo corre ctest); sale con 1 si algún caso falla
+#include "cache_lru.h"
+#include <iostream>
+#include <memory>
+#include <string>
+
+using Cache = CacheLRU<int, std::string>;
+
+static size_t fallos = 0;
+
+static void comprobar(bool ok, const std::string& caso) {
+    if (!ok) { std::cerr << "FALLO " << caso << std::endl; fallos++; }
+}
+
+static void insertar(Cache& cache, int clave, bool especulativa = false) {
+    cache.insertar(clave, std::make_shared<const std::string>(std::to_string(clave)), 10, especulativa);
+}
+
+int main() {
+    // 100 entradas de 10 bytes; el segmento de precargas admite 25
+    Cache cache(1000);
+    for (int i = 0; i < 100; i++) insertar(cache, i);
+    comprobar(cache.get_estadisticas().bytes == 1000, "el cache se llena hasta el presupuesto");
+
+    // Vecinas del capítulo 50, como precargar_vecinos
+    insertar(cache, 1000, true); insertar(cache, 1001, true);
+    comprobar(cache.contiene(1000) && cache.contiene(1001), "una precarga no expulsa a la anterior");
+    comprobar(!cache.contiene(0) && !cache.contiene(1), "las precargas expulsan las entradas usadas más frías");
+
+    // Más fallos en primer plano: expulsan entradas usadas, no las precargas recientes
+    for (int i = 100; i < 150; i++) insertar(cache, i);
+    comprobar(cache.contiene(1000) && cache.contiene(1001), "los fallos en primer plano no expulsan precargas");
+    comprobar(cache.get_estadisticas().bytes <= 1000, "el presupuesto se respeta");
+
+    auto vecina = cache.buscar(1001);
+    comprobar(vecina && *vecina == "1001", "la precarga se encuentra");
+    auto s = cache.get_estadisticas();
+    comprobar(s.precargas == 2 && s.precargas_usadas == 1, "la precarga pedida cuenta como usada");
+
+    // Pasar el segmento: solo se expulsan las precargas sin usar más viejas
+    for (int i = 2000; i < 2030; i++) insertar(cache, i, true);
+    comprobar(!cache.contiene(1000) && cache.contiene(1001), "la precarga usada pasó a la lista normal");
+    comprobar(!cache.contiene(2004) && cache.contiene(2005) && cache.contiene(2029), "el segmento de precargas queda acotado");
+    s = cache.get_estadisticas();
+    comprobar(s.bytes <= 1000 && s.entradas == 100, "las entradas y los bytes cuadran");
+
+    // Una precarga no reemplaza una entrada que ya estaba; una inserción normal sí
+    cache.insertar(1001, std::make_shared<const std::string>("otra"), 10, true);
+    vecina = cache.buscar(1001);
+    comprobar(vecina && *vecina == "1001", "la precarga no reemplaza");
+    cache.insertar(2029, std::make_shared<const std::string>("nueva"), 10);
+    auto reemplazada = cache.buscar(2029);
+    comprobar(reemplazada && *reemplazada == "nueva", "la inserción normal reemplaza a la precarga");
+
+    // descartar_si quita de las dos listas sin contar expulsiones
+    size_t expulsiones = cache.get_estadisticas().expulsiones;
+    cache.descartar_si([](int clave) { return clave >= 2000; });
+    s = cache.get_estadisticas();
+    comprobar(!cache.contiene(2029) && !cache.contiene(2010) && cache.contiene(1001) && s.entradas == 75 && s.expulsiones == expulsiones, "descartar_si quita solo las claves elegidas");
+
+    cache.vaciar();
+    s = cache.get_estadisticas();
+    comprobar(s.entradas == 0 && s.bytes == 0, "vaciar deja el cache vacío");
+
+    std::cout << "Cache LRU: " << (fallos ? "FALLO" : "correcto") << std::endl;
+    return fallos == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+// prueba_importador: verifica el lector de himnarios JSON con un corpus fijo (escapes, pares sustitutos
+// y mitades sueltas, formatos aceptados) y que importar_cantos descarte solo los cantos que fallan.
+//
+//   prueba_importador      (lo corre ctest); sale con 1 si algún caso falla
+#include "app_state.h"
+#include "importador_cantos.h"
+#include <sqlite3.h>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// `esperado`: "titulo|letra" de cada canto leído, separados por ';'
+struct Caso { const char* json; bool valido; const char* esperado; };
+
+static const Caso CORPUS[] = {
+    { R"([{"titulo": "A", "letra": "uno\ndos"}])", true, "A|uno\ndos" },
+    { R"({"cantos": [{"title": "B", "lyrics": ["e1", "e2"]}], "version": 2})", true, "B|e1\n\ne2" },
+    { R"([{"titulo": "Sin letra"}, {"letra": "sin título"}])", true, "Sin letra|" },
+    { R"([{"titulo": "Escapes", "letra": "\"c\"\t\\ \/ á"}])", true, "Escapes|\"c\"\t\\ / \xC3\xA1" },
+    // Par sustituto: U+1F600
+    { R"([{"titulo": "\uD83D\uDE00", "letra": ""}])", true, "\xF0\x9F\x98\x80|" },
+    // Mitad alta seguida de un \u que no es mitad baja: U+FFFD y el carácter siguiente se conserva
+    { R"([{"titulo": "x\uD83DAy", "letra": ""}])", true, "x\xEF\xBF\xBD" "Ay|" },
+    // Mitad alta seguida de otro par completo
+    { R"([{"titulo": "\uD83D\uD83D\uDE00", "letra": ""}])", true, "\xEF\xBF\xBD\xF0\x9F\x98\x80|" },
+    // Mitad alta sola al final de la cadena y mitad baja suelta
+    { R"([{"titulo": "fin\uD83D", "letra": "\uDE00!"}])", true, "fin\xEF\xBF\xBD|\xEF\xBF\xBD!" },
+    // Mitad alta seguida de texto normal
+    { R"([{"titulo": "\uD83Dz", "letra": ""}])", true, "\xEF\xBF\xBDz|" },
+    { R"([{"titulo": "\uD83D\u00"}])", false, "" },
+    { R"([{"titulo": "A", "letra": "sin cerrar}])", false, "" },
+    { R"([{"titulo": "A"} {"titulo": "B"}])", false, "" },
+    { R"("no es una lista")", false, "" },
+};
+
+static std::string mostrar(const std::vector<CantoImportado>& cantos) {
+    std::string s;
+    for (const auto& c : cantos) { if (!s.empty()) s += ';'; s += c.titulo + "|" + c.letra; }
+    return s;
+}
+
+// Un lote con un canto que la base rechaza (un trigger hace fallar el título "FALLA"):
+// se importan los demás y solo ese cuenta como fallido
+static size_t probar_importacion() {
+    fs::path carpeta = fs::temp_directory_path() / "prueba_importador";
+    fs::remove_all(carpeta); fs::create_directories(carpeta);
+    size_t fallos = 0;
+    {
+        // Mismo esquema que cantos.db (el índice FTS lo crea AppState al abrir)
+        sqlite3* db = nullptr;
+        if (sqlite3_open((carpeta / "cantos.db").string().c_str(), &db) != SQLITE_OK ||
+            sqlite3_exec(db, "CREATE TABLE cantos (id INTEGER PRIMARY KEY AUTOINCREMENT, titulo TEXT NOT NULL, tono TEXT, categoria TEXT);"
+                             "CREATE TABLE diapositivas (id INTEGER PRIMARY KEY AUTOINCREMENT, canto_id INTEGER, orden INTEGER, texto TEXT);"
+                             "CREATE TRIGGER falla BEFORE INSERT ON cantos WHEN NEW.titulo = 'FALLA' BEGIN SELECT RAISE(ABORT, 'rechazado'); END", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            std::cerr << "FALLO no se pudo preparar cantos.db" << std::endl; sqlite3_close(db); return 1;
+        }
+        sqlite3_close(db);
+        AppState app([](std::function<void()> trabajo) { trabajo(); }, carpeta.string());
+        app.abrir();
+
+        std::vector<CantoImportado> cantos = { { "Uno", "a\n\nb" }, { "FALLA", "x" }, { "Dos", "c" }, { "Tres", "d" }, { "Cuatro", "e\n\nf" } };
+        auto res = app.importar_cantos(cantos, 3);
+        size_t guardados = app.get_all_cantos().size();
+        if (res.cantos != 4 || res.fallidos != 1 || res.diapositivas != 6 || guardados != 4) {
+            std::cerr << "FALLO importación: " << res.cantos << " importados, " << res.fallidos << " fallidos, " << res.diapositivas << " diapositivas, " << guardados << " en la base (esperado 4, 1, 6, 4)" << std::endl;
+            fallos++;
+        }
+    }
+    fs::remove_all(carpeta);
+    return fallos;
+}
+
+int main() {
+    size_t fallos = 0;
+    for (const auto& c : CORPUS) {
+        importador::LectorJson lector(c.json); std::vector<CantoImportado> cantos;
+        lector.lista(cantos);
+        if (lector.ok != c.valido || (c.valido && mostrar(cantos) != c.esperado)) {
+            std::cerr << "FALLO " << c.json << ": ok=" << lector.ok << " \"" << mostrar(cantos) << "\"" << std::endl; fallos++;
+        }
+    }
+    std::cout << "Corpus JSON: " << std::size(CORPUS) - fallos << "/" << std::size(CORPUS) << " casos correctos" << std::endl;
+    size_t fallos_importacion = probar_importacion();
+    std::cout << "Importación con un canto rechazado: " << (fallos_importacion ? "FALLO" : "correcta") << std::endl;
+    return fallos + fallos_importacion == 0 ? 0 : 1;
+}